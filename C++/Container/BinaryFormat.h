@@ -0,0 +1,152 @@
+//**************************************************************
+//         binary file format of Vector snapshots
+//**************************************************************
+
+#ifndef BINARYFORMAT_H
+#define BINARYFORMAT_H
+
+#include <cstdint>
+#include <cstring>
+#include <stdexcept>
+#include <string>
+
+#if defined(_WIN32)
+#include <io.h>
+#else
+#include <unistd.h>
+#endif
+
+using namespace std;
+
+// a snapshot file is a 64 bytes header followed by raw bytes of elements:
+//
+//   offset 0:  magic "PLVECTOR"
+//   offset 8:  format version(uint32)
+//   offset 12: element size in bytes(uint32)
+//   offset 16: element count(uint64)
+//   offset 24: checksum of element bytes(uint64)
+//   offset 32: offset of element bytes from file start(uint64), 64 for version 1
+//   offset 40: reserved, zero
+//   offset 64: elements
+//
+// elements are written as they are in memory, so only trivially copyable types can be saved,
+// and file is only readable on machines of the same byte order and type layout.
+// element bytes start at 64, so when the file is mapped at a page boundary, elements are aligned
+// for every type up to cache line alignment and can be used in place without copying(see MappedVector).
+
+struct VectorFileHeader
+{
+    char magic[8];
+    uint32_t version;
+    uint32_t elementSize;
+    uint64_t count;
+    uint64_t checksum;
+    uint64_t dataOffset;
+    char reserved[24];
+};
+
+static_assert(sizeof(VectorFileHeader) == 64, "header should be 64 bytes.");
+
+const char VectorFileMagic[8] = { 'P', 'L', 'V', 'E', 'C', 'T', 'O', 'R' };
+const uint32_t VectorFileVersion = 1;
+
+// 64-bit checksum of bytes, 4 independent FNV-1a style lanes over 8-byte words,
+// so it runs at memory speed instead of one multiplication per byte.
+inline uint64_t ChecksumBytes(const void* data, size_t size)
+{
+    const uint64_t prime = 0x100000001b3ULL;
+    uint64_t lanes[4] = { 0xcbf29ce484222325ULL, 0x84222325cbf29ce4ULL, 0x9ce484222325cbf2ULL, 0x2325cbf29ce48422ULL };
+    const unsigned char* bytes = (const unsigned char*)data;
+    size_t index = 0;
+    for (; index + 32 <= size; index += 32)
+    {
+        for (int lane = 0; lane < 4; ++lane)
+        {
+            uint64_t word;
+            std::memcpy(&word, bytes + index + lane * 8, 8);
+            lanes[lane] = (lanes[lane] ^ word) * prime;
+        }
+    }
+
+    uint64_t hash = size;
+    for (int lane = 0; lane < 4; ++lane)
+    {
+        hash = (hash ^ lanes[lane]) * prime;
+    }
+    for (; index < size; ++index)
+    {
+        hash = (hash ^ bytes[index]) * prime;
+    }
+    return hash;
+}
+
+inline VectorFileHeader MakeVectorFileHeader(size_t elementSize, size_t count, uint64_t checksum)
+{
+    VectorFileHeader header;
+    std::memset(&header, 0, sizeof(header));
+    std::memcpy(header.magic, VectorFileMagic, sizeof(header.magic));
+    header.version = VectorFileVersion;
+    header.elementSize = uint32_t(elementSize);
+    header.count = count;
+    header.checksum = checksum;
+    header.dataOffset = sizeof(VectorFileHeader);
+    return header;
+}
+
+// throw std::runtime_error if header is not a valid header of elements of elementSize bytes.
+// data must start at a multiple of elementAlignment, so mapped elements are aligned.
+inline void CheckVectorFileHeader(const VectorFileHeader& header, size_t elementSize, size_t elementAlignment)
+{
+    if (std::memcmp(header.magic, VectorFileMagic, sizeof(header.magic)) != 0)
+        throw std::runtime_error("Error: not a vector file.");
+    if (header.version != VectorFileVersion)
+        throw std::runtime_error("Error: unsupported vector file version " + std::to_string(header.version) + ".");
+    if (header.elementSize != elementSize)
+        throw std::runtime_error("Error: element size of vector file does not match.");
+    if (header.dataOffset < sizeof(VectorFileHeader) || header.dataOffset % elementAlignment != 0
+        || (size_t(-1) - header.dataOffset) / elementSize < header.count)
+        throw std::runtime_error("Error: corrupted vector file header.");
+}
+
+// write all size bytes to file descriptor, a single write may write less than asked.
+inline void WriteBytes(int fd, const void* data, size_t size)
+{
+    const char* bytes = (const char*)data;
+    while (size > 0)
+    {
+        // keep each request below 1GB, windows _write takes unsigned int.
+        unsigned chunk = unsigned(size < (1u << 30) ? size : (1u << 30));
+#if defined(_WIN32)
+        int written = ::_write(fd, bytes, chunk);
+#else
+        ssize_t written = ::write(fd, bytes, chunk);
+#endif
+        if (written <= 0)
+            throw std::runtime_error("Error: failed to write vector file.");
+
+        bytes += written;
+        size -= size_t(written);
+    }
+}
+
+// read exactly size bytes from file descriptor.
+inline void ReadBytes(int fd, void* data, size_t size)
+{
+    char* bytes = (char*)data;
+    while (size > 0)
+    {
+        unsigned chunk = unsigned(size < (1u << 30) ? size : (1u << 30));
+#if defined(_WIN32)
+        int bytesRead = ::_read(fd, bytes, chunk);
+#else
+        ssize_t bytesRead = ::read(fd, bytes, chunk);
+#endif
+        if (bytesRead <= 0)
+            throw std::runtime_error("Error: vector file is truncated.");
+
+        bytes += bytesRead;
+        size -= size_t(bytesRead);
+    }
+}
+
+#endif
@@ -0,0 +1,570 @@
+//**************************************************************
+//         bit packed vector of bool with word level operations
+//**************************************************************
+
+#ifndef BITVECTOR_H
+#define BITVECTOR_H
+
+#include <cassert>
+#include <cstdint>
+#include <iostream>
+#include <stdexcept>
+#include "Vector.h"
+#include "VectorAlgorithm.h"
+
+using namespace std;
+
+// Vector<bool> spends a byte per flag. BitVector packs 64 flags into one 64-bit word:
+// bit i is bit (i % 64) of word i / 64. memory drops 8 times, and operations work on a whole word
+// at once: Count adds popcount of each word, FindFirst/FindNext skip zero words and take the lowest
+// set bit by counting trailing zeros, And/Or/Xor/AndNot combine 64 flags per instruction.
+// bits beyond Size() in the last word are always kept 0, so word operations need no masking.
+
+/*******************************************************/
+// word helpers
+/*******************************************************/
+
+inline size_t PopCount64(uint64_t word)
+{
+    // count bits of 2, 4, 8 bit groups in parallel(SWAR), then sum bytes by multiplication.
+    word = word - ((word >> 1) & 0x5555555555555555ULL);
+    word = (word & 0x3333333333333333ULL) + ((word >> 2) & 0x3333333333333333ULL);
+    word = (word + (word >> 4)) & 0x0F0F0F0F0F0F0F0FULL;
+    return size_t((word * 0x0101010101010101ULL) >> 56);
+}
+
+inline size_t PopCountWordsScalar(const uint64_t* first, const uint64_t* last)
+{
+    size_t count = 0;
+    for (; first != last; ++first)
+    {
+        count += PopCount64(*first);
+    }
+    return count;
+}
+
+#ifdef VECTOR_ALGORITHM_X86
+
+// popcnt instruction, one word per cycle.
+SIMD_TARGET_SSE42 inline size_t PopCountWordsPopcnt(const uint64_t* first, const uint64_t* last)
+{
+    size_t count = 0;
+    for (; first != last; ++first)
+    {
+#if defined(_MSC_VER) && defined(_M_X64)
+        count += size_t(__popcnt64(*first));
+#elif defined(_MSC_VER)
+        count += size_t(__popcnt(unsigned(*first)) + __popcnt(unsigned(*first >> 32)));
+#else
+        count += size_t(__builtin_popcountll(*first));
+#endif
+    }
+    return count;
+}
+
+#endif
+
+// number of set bits in words [first, last), popcnt is used if cpu supports it.
+inline size_t PopCountWords(const uint64_t* first, const uint64_t* last)
+{
+#ifdef VECTOR_ALGORITHM_X86
+    if (GetSimdLevel() >= SimdSSE42)
+        return PopCountWordsPopcnt(first, last);
+#endif
+    return PopCountWordsScalar(first, last);
+}
+
+// index of the lowest set bit, word must not be 0.
+inline size_t CountTrailingZeros64(uint64_t word)
+{
+#if defined(_MSC_VER) && defined(_M_X64)
+    unsigned long index;
+    _BitScanForward64(&index, word);
+    return index;
+#elif defined(_MSC_VER)
+    unsigned long index;
+    if (_BitScanForward(&index, (unsigned long)word))
+        return index;
+    _BitScanForward(&index, (unsigned long)(word >> 32));
+    return index + 32;
+#else
+    return size_t(__builtin_ctzll(word));
+#endif
+}
+
+// proxy reference to one bit, since a bit has no address.
+class BitReference
+{
+public:
+    BitReference(uint64_t* w, uint64_t m) :word(w), mask(m)
+    {
+    }
+
+    operator bool() const
+    {
+        return (*word & mask) != 0;
+    }
+
+    BitReference& operator=(bool value)
+    {
+        if (value)
+            *word |= mask;
+        else
+            *word &= ~mask;
+        return *this;
+    }
+
+    // assign value of another bit, not rebind the reference.
+    BitReference& operator=(const BitReference& other)
+    {
+        return *this = bool(other);
+    }
+
+    void Flip()
+    {
+        *word ^= mask;
+    }
+
+private:
+    uint64_t* word;
+    uint64_t mask;
+};
+
+class BitVector
+{
+public:
+    static const size_t WordBits = 64;
+    // returned by FindFirst/FindNext if no bit is found.
+    static const size_t NotFound = size_t(-1);
+
+    // index based iterator, dereference gives BitReference.
+    class iterator
+    {
+    public:
+        iterator() :vec(nullptr), index(0)
+        {
+        }
+
+        iterator(BitVector* v, size_t i) :vec(v), index(i)
+        {
+        }
+
+        bool operator==(const iterator& other) const
+        {
+            return index == other.index;
+        }
+
+        bool operator!=(const iterator& other) const
+        {
+            return index != other.index;
+        }
+
+        BitReference operator*() const
+        {
+            return (*vec)[index];
+        }
+
+        // pre-increment
+        iterator& operator++()
+        {
+            ++index;
+            return *this;
+        }
+
+        // post-increment
+        iterator operator++(int)
+        {
+            iterator temp = *this;
+            ++index;
+            return temp;
+        }
+
+    private:
+        BitVector* vec;
+        size_t index;
+    };
+
+    /*******************************************************/
+    // ctor and dtor
+    /*******************************************************/
+    BitVector() :size(0)
+    {
+    }
+
+    explicit BitVector(size_t count, bool value = false) :words(WordCount(count), value ? ~uint64_t(0) : 0), size(count)
+    {
+        ClearUnusedBits();
+    }
+
+    /*******************************************************/
+    // Capacity
+    /*******************************************************/
+    bool Empty() const
+    {
+        return size == 0;
+    }
+
+    // number of bits.
+    size_t Size() const
+    {
+        return size;
+    }
+
+    size_t Capacity() const
+    {
+        return words.Capacity() * WordBits;
+    }
+
+    void Reserve(size_t newCapacity)
+    {
+        words.Reserve(WordCount(newCapacity));
+    }
+
+    /*******************************************************/
+    // Modifiers
+    /*******************************************************/
+
+    void Clear()
+    {
+        words.Clear();
+        size = 0;
+    }
+
+    void Push_Back(bool value)
+    {
+        if (size % WordBits == 0)
+        {
+            words.Push_Back(0);
+        }
+        if (value)
+        {
+            words.Back() |= uint64_t(1) << (size % WordBits);
+        }
+        ++size;
+    }
+
+    void Pop_Back()
+    {
+        --size;
+        if (size % WordBits == 0)
+            words.Pop_back();
+        else
+            words.Back() &= ~(uint64_t(1) << (size % WordBits));
+    }
+
+    // Resizes to count bits, new bits are set to value.
+    void Resize(size_t count, bool value = false)
+    {
+        size_t oldSize = size;
+        words.Resize(WordCount(count), value ? ~uint64_t(0) : 0);
+        size = count;
+        if (value && count > oldSize && oldSize % WordBits != 0)
+        {
+            // fill the rest of old last word.
+            words[oldSize / WordBits] |= ~uint64_t(0) << (oldSize % WordBits);
+        }
+        ClearUnusedBits();
+    }
+
+    void Set(size_t pos, bool value = true)
+    {
+        (*this)[pos] = value;
+    }
+
+    void Reset(size_t pos)
+    {
+        (*this)[pos] = false;
+    }
+
+    void Flip(size_t pos)
+    {
+        (*this)[pos].Flip();
+    }
+
+    // set all bits to value.
+    void SetAll(bool value = true)
+    {
+        std::fill(words.Begin(), words.End(), value ? ~uint64_t(0) : 0);
+        ClearUnusedBits();
+    }
+
+    // flip all bits.
+    void FlipAll()
+    {
+        for (uint64_t* word = words.Begin(); word != words.End(); ++word)
+        {
+            *word = ~*word;
+        }
+        ClearUnusedBits();
+    }
+
+    /*******************************************************/
+    // Word level operations
+    /*******************************************************/
+
+    // bitwise operations with another vector of the same size, 64 bits per step.
+    // If sizes differ, an exception of type std::invalid_argument is thrown.
+    BitVector& operator&=(const BitVector& other)
+    {
+        CheckSameSize(other);
+        const uint64_t* source = other.words.Begin();
+        for (uint64_t* word = words.Begin(); word != words.End(); ++word, ++source)
+        {
+            *word &= *source;
+        }
+        return *this;
+    }
+
+    BitVector& operator|=(const BitVector& other)
+    {
+        CheckSameSize(other);
+        const uint64_t* source = other.words.Begin();
+        for (uint64_t* word = words.Begin(); word != words.End(); ++word, ++source)
+        {
+            *word |= *source;
+        }
+        return *this;
+    }
+
+    BitVector& operator^=(const BitVector& other)
+    {
+        CheckSameSize(other);
+        const uint64_t* source = other.words.Begin();
+        for (uint64_t* word = words.Begin(); word != words.End(); ++word, ++source)
+        {
+            *word ^= *source;
+        }
+        return *this;
+    }
+
+    // clear bits which are set in other, this & ~other.
+    BitVector& AndNot(const BitVector& other)
+    {
+        CheckSameSize(other);
+        const uint64_t* source = other.words.Begin();
+        for (uint64_t* word = words.Begin(); word != words.End(); ++word, ++source)
+        {
+            *word &= ~*source;
+        }
+        return *this;
+    }
+
+    // Returns number of set bits.
+    size_t Count() const
+    {
+        return PopCountWords(words.Begin(), words.End());
+    }
+
+    bool Any() const
+    {
+        for (const uint64_t* word = words.Begin(); word != words.End(); ++word)
+        {
+            if (*word != 0)
+                return true;
+        }
+        return false;
+    }
+
+    bool None() const
+    {
+        return !Any();
+    }
+
+    // Returns index of the first set bit, or NotFound.
+    size_t FindFirst() const
+    {
+        return FindFromWord(0);
+    }
+
+    // Returns index of the first set bit after pos, or NotFound.
+    size_t FindNext(size_t pos) const
+    {
+        ++pos;
+        if (pos >= size)
+            return NotFound;
+
+        size_t index = pos / WordBits;
+        // drop bits before pos in its word.
+        uint64_t word = words.Begin()[index] & (~uint64_t(0) << (pos % WordBits));
+        if (word != 0)
+            return index * WordBits + CountTrailingZeros64(word);
+
+        return FindFromWord(index + 1);
+    }
+
+    /*******************************************************/
+    // Iterators
+    /*******************************************************/
+
+    // specially for "Range for". Need begin(),end().
+    iterator begin()
+    {
+        return Begin();
+    }
+
+    iterator end()
+    {
+        return End();
+    }
+
+    iterator Begin()
+    {
+        return iterator(this, 0);
+    }
+
+    iterator End()
+    {
+        return iterator(this, size);
+    }
+
+    /*******************************************************/
+    // Accessor
+    /*******************************************************/
+
+    // Returns a reference to the bit at specified location pos, with bounds checking.
+    // If pos is not within the range of the container, an exception of type std::out_of_range is thrown.
+    BitReference At(size_t pos)
+    {
+        if (pos >= size)
+            throw std::out_of_range("Error: out of range of bit vector.");
+
+        return (*this)[pos];
+    }
+
+    // Returns a reference to the bit at specified location pos. No bounds checking is performed.
+    BitReference operator[](size_t pos)
+    {
+        return BitReference(&words[pos / WordBits], uint64_t(1) << (pos % WordBits));
+    }
+
+    bool operator[](size_t pos) const
+    {
+        return Test(pos);
+    }
+
+    bool Test(size_t pos) const
+    {
+        return (words.Begin()[pos / WordBits] >> (pos % WordBits)) & 1;
+    }
+
+    // underlying words, e.g. to save them or scan them by VectorAlgorithm.
+    const Vector<uint64_t>& Words() const
+    {
+        return words;
+    }
+
+private:
+    static size_t WordCount(size_t bits)
+    {
+        return (bits + WordBits - 1) / WordBits;
+    }
+
+    // keep bits beyond size in last word zero.
+    void ClearUnusedBits()
+    {
+        if (size % WordBits != 0)
+        {
+            words.Back() &= ~(~uint64_t(0) << (size % WordBits));
+        }
+    }
+
+    void CheckSameSize(const BitVector& other) const
+    {
+        if (size != other.size)
+            throw std::invalid_argument("Error: bit vectors have different sizes.");
+    }
+
+    // Returns index of the first set bit from word index, skipping zero words.
+    size_t FindFromWord(size_t index) const
+    {
+        const uint64_t* first = words.Begin();
+        size_t count = words.Size();
+        for (; index < count; ++index)
+        {
+            if (first[index] != 0)
+                return index * WordBits + CountTrailingZeros64(first[index]);
+        }
+        return NotFound;
+    }
+
+private:
+    Vector<uint64_t> words;
+    size_t size; // number of bits
+};
+
+inline BitVector operator&(BitVector left, const BitVector& right)
+{
+    return left &= right;
+}
+
+inline BitVector operator|(BitVector left, const BitVector& right)
+{
+    return left |= right;
+}
+
+inline BitVector operator^(BitVector left, const BitVector& right)
+{
+    return left ^= right;
+}
+
+// test routines for bit vector
+void TestBitVector()
+{
+    BitVector bits;
+    for (int i = 0; i < 10; i++)
+    {
+        bits.Push_Back(i % 3 == 0);
+    }
+    for (auto bit : bits)
+    {
+        cout << bit;
+    }
+    cout << endl;
+
+    bits[1] = true;
+    bits.Flip(0);
+    bits.Pop_Back();
+    cout << "Count: " << bits.Count() << ", FindFirst: " << bits.FindFirst() << ", FindNext(3): " << bits.FindNext(3) << endl;
+
+    // across words.
+    BitVector a(200), b(200);
+    for (size_t i = 0; i < 200; i += 3)
+        a.Set(i);
+    for (size_t i = 0; i < 200; i += 5)
+        b.Set(i);
+    size_t expectedAnd = 0, expectedOr = 0, expectedXor = 0, expectedAndNot = 0;
+    for (size_t i = 0; i < 200; i++)
+    {
+        bool x = i % 3 == 0;
+        bool y = i % 5 == 0;
+        expectedAnd += x && y;
+        expectedOr += x || y;
+        expectedXor += x != y;
+        expectedAndNot += x && !y;
+    }
+    BitVector andNot(a);
+    andNot.AndNot(b);
+    assert((a & b).Count() == expectedAnd && (a | b).Count() == expectedOr);
+    assert((a ^ b).Count() == expectedXor && andNot.Count() == expectedAndNot);
+
+    // visit set bits of a & b: multiples of 15.
+    BitVector both = a & b;
+    for (size_t pos = both.FindFirst(); pos != BitVector::NotFound; pos = both.FindNext(pos))
+    {
+        cout << pos << " ";
+    }
+    cout << endl;
+
+    // bits beyond size stay 0.
+    BitVector c(70, true);
+    c.Resize(130, true);
+    c.FlipAll();
+    c.Resize(140);
+    assert(c.Count() == 0 && c.FindFirst() == BitVector::NotFound);
+    c.SetAll();
+    assert(c.Count() == 140 && c.Test(139));
+
+    cout << "end of test BitVector." << endl;
+}
+
+#endif
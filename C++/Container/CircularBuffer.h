@@ -0,0 +1,519 @@
+//**************************************************************
+//         fixed-capacity circular buffer(ring buffer)
+//**************************************************************
+
+#ifndef CIRCULARBUFFER_H
+#define CIRCULARBUFFER_H
+
+#include <algorithm>
+#include <cassert>
+#include <iostream>
+#include <iterator>
+#include <memory>
+#include <stdexcept>
+#include <utility>
+#include "..\Memory\Allocator.h"
+
+using namespace std;
+
+// a bounded window over a stream(e.g. the last N events) kept in a Vector needs Erase(Begin())
+// for every new element once it is full, which shifts all N elements.
+// CircularBuffer stores elements in a ring of slots allocated once at construction and never
+// reallocated: pushing at back and popping at front only move the indices, O(1) and no shifting.
+//
+// number of slots is capacity rounded up to a power of two, so slot of element i is found with
+// (head + i) & mask instead of a division. Capacity() is still the capacity asked for,
+// the buffer never holds more elements than that.
+//
+// elements of the ring are consecutive in at most two runs: from head to the end of slots,
+// and from slot 0 on. bulk Push_N/Pop_N copy each run in one go.
+
+// what a push does when buffer is full.
+enum CircularBufferMode
+{
+    CircularOverwriteOldest, // oldest element is dropped to make room, push always succeeds
+    CircularRejectWhenFull   // push fails and buffer is unchanged
+};
+
+template<typename T, typename Alloc = Allocator<T>>
+class CircularBuffer : private Alloc
+{
+public:
+    typedef T value_type;
+    typedef T& reference;
+    typedef const T& const_reference;
+    typedef Alloc allocator_type;
+
+    /*******************************************************/
+    // ctor and dtor
+    /*******************************************************/
+
+    // If capacity is 0, an exception of type std::invalid_argument is thrown.
+    explicit CircularBuffer(size_t capacity, CircularBufferMode mode = CircularOverwriteOldest)
+        :_slots(nullptr), _mask(0), _capacity(capacity), _head(0), _size(0), _mode(mode)
+    {
+        if (capacity == 0)
+            throw std::invalid_argument("Error: capacity of circular buffer is 0.");
+
+        size_t slotCount = 1;
+        while (slotCount < capacity)
+        {
+            slotCount <<= 1;
+        }
+        _slots = GetAlloc().allocate(slotCount);
+        _mask = slotCount - 1;
+    }
+
+    CircularBuffer(const CircularBuffer& other)
+        :Alloc(other), _slots(nullptr), _mask(other._mask), _capacity(other._capacity), _head(0), _size(0), _mode(other._mode)
+    {
+        _slots = GetAlloc().allocate(_mask + 1);
+        try
+        {
+            for (size_t i = 0; i < other._size; ++i)
+            {
+                Emplace_Back(other[i]);
+            }
+        }
+        catch (...)
+        {
+            Clear();
+            GetAlloc().deallocate(_slots, _mask + 1);
+            throw;
+        }
+    }
+
+    // other is left without storage, only destruction and assignment are valid for it.
+    CircularBuffer(CircularBuffer&& other)
+        :Alloc(std::move(other)), _slots(nullptr), _mask(0), _capacity(0), _head(0), _size(0), _mode(other._mode)
+    {
+        SwapStorage(other);
+    }
+
+    ~CircularBuffer()
+    {
+        Tidy();
+    }
+
+    CircularBuffer& operator=(const CircularBuffer& other)
+    {
+        if (this != &other)
+        {
+            CircularBuffer temp(other);
+            Swap(temp);
+        }
+        return *this;
+    }
+
+    CircularBuffer& operator=(CircularBuffer&& other)
+    {
+        if (this != &other)
+        {
+            CircularBuffer temp(std::move(other));
+            Swap(temp);
+        }
+        return *this;
+    }
+
+    void Swap(CircularBuffer& other)
+    {
+        // storage goes with the allocator owning it.
+        std::swap(GetAlloc(), other.GetAlloc());
+        SwapStorage(other);
+    }
+
+    /*******************************************************/
+    // Capacity
+    /*******************************************************/
+    bool Empty() const
+    {
+        return _size == 0;
+    }
+
+    bool Full() const
+    {
+        return _size == _capacity;
+    }
+
+    size_t Size() const
+    {
+        return _size;
+    }
+
+    size_t Capacity() const
+    {
+        return _capacity;
+    }
+
+    CircularBufferMode Mode() const
+    {
+        return _mode;
+    }
+
+    /*******************************************************/
+    // Modifiers
+    /*******************************************************/
+    void Clear()
+    {
+        while (_size > 0)
+        {
+            Pop_Front();
+        }
+        _head = 0;
+    }
+
+    // Returns false if buffer is full in reject mode, value is not pushed then.
+    bool Push_Back(const T& value)
+    {
+        return Emplace_Back(value);
+    }
+
+    bool Push_Back(T&& value)
+    {
+        return Emplace_Back(std::move(value));
+    }
+
+    // constructs an element in-place at the end.
+    // Returns false if buffer is full in reject mode, no element is constructed then.
+    // in overwrite mode the new element is constructed before the oldest one is dropped,
+    // so args may refer to an element of the buffer, e.g. Push_Back(Front()).
+    template<class... Args>
+    bool Emplace_Back(Args&&... args)
+    {
+        if (!Full())
+        {
+            GetAlloc().construct(Slot(_size), std::forward<Args>(args)...);
+            ++_size;
+            return true;
+        }
+
+        if (_mode == CircularRejectWhenFull)
+            return false;
+
+        if (_capacity <= _mask)
+        {
+            // a spare slot follows the last element.
+            GetAlloc().construct(Slot(_size), std::forward<Args>(args)...);
+            GetAlloc().destroy(Slot(0));
+        }
+        else
+        {
+            // the new element takes the slot of the oldest one, so it is built aside first.
+            T value(std::forward<Args>(args)...);
+            GetAlloc().destroy(Slot(0));
+            try
+            {
+                GetAlloc().construct(Slot(0), std::move(value));
+            }
+            catch (...)
+            {
+                // oldest element is gone anyway.
+                _head = (_head + 1) & _mask;
+                --_size;
+                throw;
+            }
+        }
+        _head = (_head + 1) & _mask;
+        return true;
+    }
+
+    // Calling Pop_Front on an empty container is undefined.
+    void Pop_Front()
+    {
+        assert(_size > 0);
+        GetAlloc().destroy(Slot(0));
+        _head = (_head + 1) & _mask;
+        --_size;
+    }
+
+    // pushes count values at back, copied in at most two runs.
+    // in overwrite mode all values are pushed and the oldest elements are dropped to make room,
+    // if count exceeds capacity only the last Capacity() values are kept.
+    // in reject mode only as many values as there are free slots are pushed.
+    // Returns the number of values pushed.
+    size_t Push_N(const T* values, size_t count)
+    {
+        size_t pushed = count;
+        if (_mode == CircularOverwriteOldest)
+        {
+            if (count > _capacity)
+            {
+                values += count - _capacity;
+                count = _capacity;
+            }
+            size_t overflow = _size + count > _capacity ? _size + count - _capacity : 0;
+            DestroyFront(overflow);
+        }
+        else
+        {
+            count = std::min(count, _capacity - _size);
+            pushed = count;
+        }
+
+        // first run up to the end of slots, second run from slot 0.
+        size_t tail = (_head + _size) & _mask;
+        size_t first = std::min(count, _mask + 1 - tail);
+        std::uninitialized_copy(values, values + first, _slots + tail);
+        _size += first;
+        std::uninitialized_copy(values + first, values + count, _slots);
+        _size += count - first;
+        return pushed;
+    }
+
+    // moves up to count oldest elements to out, in at most two runs, and pops them.
+    // Returns the number of elements popped.
+    size_t Pop_N(T* out, size_t count)
+    {
+        count = std::min(count, _size);
+        size_t first = std::min(count, _mask + 1 - _head);
+        out = std::move(_slots + _head, _slots + _head + first, out);
+        std::move(_slots, _slots + (count - first), out);
+        DestroyFront(count);
+        return count;
+    }
+
+    /*******************************************************/
+    // Iterators
+    /*******************************************************/
+
+    // iterates from the oldest element to the newest one.
+    class iterator
+    {
+    public:
+        typedef std::forward_iterator_tag iterator_category;
+        typedef T value_type;
+        typedef ptrdiff_t difference_type;
+        typedef T* pointer;
+        typedef T& reference;
+
+        iterator() :_buffer(nullptr), _index(0)
+        {
+        }
+
+        iterator(CircularBuffer* buffer, size_t index) :_buffer(buffer), _index(index)
+        {
+        }
+
+        bool operator==(const iterator& other) const
+        {
+            return _index == other._index;
+        }
+
+        bool operator!=(const iterator& other) const
+        {
+            return _index != other._index;
+        }
+
+        reference operator*() const
+        {
+            return (*_buffer)[_index];
+        }
+
+        pointer operator->() const
+        {
+            return &(*_buffer)[_index];
+        }
+
+        // pre-increment
+        iterator& operator++()
+        {
+            ++_index;
+            return *this;
+        }
+
+        // post-increment
+        iterator operator++(int)
+        {
+            iterator temp = *this;
+            ++_index;
+            return temp;
+        }
+
+    private:
+        CircularBuffer* _buffer;
+        size_t _index; // 0 for the oldest element
+    };
+
+    // specially for "Range for". Need begin(),end().
+    iterator begin()
+    {
+        return Begin();
+    }
+
+    iterator end()
+    {
+        return End();
+    }
+
+    iterator Begin()
+    {
+        return iterator(this, 0);
+    }
+
+    iterator End()
+    {
+        return iterator(this, _size);
+    }
+
+    /*******************************************************/
+    // Accessor
+    /*******************************************************/
+
+    // Returns a reference to the element at specified location pos, 0 is the oldest element, with bounds checking.
+    // If pos is not within the range of the container, an exception of type std::out_of_range is thrown.
+    reference At(size_t pos)
+    {
+        if (pos >= _size)
+            throw std::out_of_range("Error: out of range of circular buffer.");
+
+        return (*this)[pos];
+    }
+
+    // Returns a reference to the element at specified location pos. No bounds checking is performed.
+    reference operator[](size_t pos)
+    {
+        return *Slot(pos);
+    }
+
+    const_reference operator[](size_t pos) const
+    {
+        return _slots[(_head + pos) & _mask];
+    }
+
+    // oldest element. Calling front on an empty container is undefined.
+    reference Front()
+    {
+        return *Slot(0);
+    }
+
+    // newest element. Calling back on an empty container is undefined.
+    reference Back()
+    {
+        return *Slot(_size - 1);
+    }
+
+private:
+    Alloc& GetAlloc()
+    {
+        return *this;
+    }
+
+    // swap elements and storage, but not allocators.
+    void SwapStorage(CircularBuffer& other)
+    {
+        std::swap(_slots, other._slots);
+        std::swap(_mask, other._mask);
+        std::swap(_capacity, other._capacity);
+        std::swap(_head, other._head);
+        std::swap(_size, other._size);
+        std::swap(_mode, other._mode);
+    }
+
+    // slot of element pos.
+    T* Slot(size_t pos)
+    {
+        return _slots + ((_head + pos) & _mask);
+    }
+
+    // destroy count oldest elements, in at most two runs.
+    void DestroyFront(size_t count)
+    {
+        size_t first = std::min(count, _mask + 1 - _head);
+        for (size_t i = 0; i < first; ++i)
+        {
+            GetAlloc().destroy(_slots + _head + i);
+        }
+        for (size_t i = 0; i < count - first; ++i)
+        {
+            GetAlloc().destroy(_slots + i);
+        }
+        _head = (_head + count) & _mask;
+        _size -= count;
+    }
+
+    void Tidy()
+    {
+        if (_slots != nullptr)
+        {
+            Clear();
+            GetAlloc().deallocate(_slots, _mask + 1);
+        }
+        _slots = nullptr;
+    }
+
+private:
+    T* _slots;         // power of two slots
+    size_t _mask;      // number of slots - 1
+    size_t _capacity;  // max number of elements, not more than number of slots
+    size_t _head;      // slot of the oldest element
+    size_t _size;
+    CircularBufferMode _mode;
+};
+
+// test routines for circular buffer
+void TestCircularBuffer()
+{
+    // capacity 6 uses 8 slots, keeps the last 6 values.
+    CircularBuffer<int> history(6);
+    for (int i = 0; i < 13; i++)
+    {
+        history.Push_Back(i);
+    }
+    for (auto v : history)
+    {
+        cout << v << " ";
+    }
+    cout << endl;
+    assert(history.Size() == 6 && history.Front() == 7 && history.Back() == 12);
+
+    // bulk push and pop wrap around the end of slots.
+    int values[] = { 100, 101, 102, 103 };
+    assert(history.Push_N(values, 4) == 4);
+    assert(history.Size() == 6 && history[0] == 11 && history[5] == 103);
+
+    int out[8] = { 0 };
+    assert(history.Pop_N(out, 8) == 6);
+    assert(history.Empty() && out[0] == 11 && out[5] == 103);
+
+    // reject mode.
+    CircularBuffer<string> queue(3, CircularRejectWhenFull);
+    assert(queue.Push_Back("a") && queue.Push_Back("b") && queue.Push_Back("c"));
+    assert(!queue.Push_Back("d") && queue.Full() && queue.Back() == "c");
+    queue.Pop_Front();
+    string more[] = { "e", "f" };
+    assert(queue.Push_N(more, 2) == 1 && queue[0] == "b" && queue[2] == "e");
+
+    // copies are independent.
+    CircularBuffer<string> copy(queue);
+    copy.Pop_Front();
+    assert(copy.Size() == 2 && queue.Size() == 3 && copy.Front() == "c");
+
+    // pushing the oldest element of a full buffer copies it before it is dropped,
+    // with a spare slot(capacity 3 of 4 slots) and without(capacity 2 of 2 slots).
+    for (size_t capacity = 2; capacity <= 3; capacity++)
+    {
+        CircularBuffer<string> recent(capacity);
+        for (size_t i = 0; i < capacity; i++)
+        {
+            recent.Push_Back("a string too long to be stored inline " + to_string(i));
+        }
+        recent.Push_Back(recent.Front());
+        assert(recent.Size() == capacity && recent.Back() == "a string too long to be stored inline 0");
+        recent.Emplace_Back(recent.Front(), 0, 1);
+        assert(recent.Back() == "a");
+    }
+
+    try
+    {
+        queue.At(3);
+        assert(false);
+    }
+    catch (const std::out_of_range& error)
+    {
+        cout << error.what() << endl;
+    }
+
+    cout << "end of test CircularBuffer." << endl;
+}
+
+#endif
@@ -0,0 +1,623 @@
+//**************************************************************
+//         vector which grows concurrently, as tbb::concurrent_vector
+//**************************************************************
+
+#ifndef CONCURRENT_VECTOR_H
+#define CONCURRENT_VECTOR_H
+
+#include <atomic>
+#include <cassert>
+#include <iostream>
+#include <stdexcept>
+#include <thread>
+#include <utility>
+#include <vector>
+#include "..\Memory\Allocator.h"
+
+#if defined(_MSC_VER)
+#include <intrin.h>
+#endif
+
+using namespace std;
+
+// Vector can not grow concurrently: reallocation moves all elements, so every reader and writer
+// must be stopped(e.g. by a mutex) while one thread appends.
+// ConcurrentVector never moves elements. storage is a list of segments whose sizes are powers of two,
+// segment k holds FirstSegmentSize * 2^k elements, so segments cover indices as below:
+//   segment 0: [0, 8), segment 1: [8, 24), segment 2: [24, 56), ...
+// the segment of index i is found from the highest bit of i + FirstSegmentSize, O(1) without lookup.
+// 1. Push_Back/Emplace_Back/Grow_By claim their indices by one atomic fetch_add on the claim counter,
+//    so writers never wait for each other, except when they race to allocate the same segment.
+// 2. a segment is allocated by the first writer which needs it and published by compare-exchange,
+//    loser frees its own allocation. a segment keeps one state byte per slot after its elements.
+// 3. after constructing, a writer marks its slot ready. if the constructor throws, the slot is marked
+//    broken instead, iterators skip it and At rejects it. Size() is the count of leading finished(ready
+//    or broken) slots, it is advanced by whichever writer finishes the slot at Size(), so a writer never
+//    waits for a slower one. Size(), At() and End() only see finished slots.
+// 4. references, pointers and indices of elements stay valid until Clear or destruction.
+//
+// readers may index any element while writers append, as long as the element has been constructed:
+// Push_Back returns the index of new element, reading it is safe once that index is passed to the reader
+// (e.g. through a queue or an atomic), or once it is below Size() and not broken.
+// if a segment can not be allocated, the slots claimed in it are never finished and Size() stays below them.
+// Clear and destruction are not thread-safe.
+template<typename T, typename Alloc = Allocator<T>>
+class ConcurrentVector : private Alloc
+{
+    // state of a slot.
+    enum SlotState : unsigned char
+    {
+        SlotEmpty = 0,  // claimed, under construction, or not claimed yet
+        SlotReady = 1,  // holds a constructed element
+        SlotBroken = 2  // construction threw, holds nothing
+    };
+    typedef std::atomic<unsigned char> StateType;
+
+public:
+    typedef T value_type;
+    typedef T& reference;
+    typedef const T& const_reference;
+
+    static const size_t FirstSegmentSizeBits = 3;
+    static const size_t FirstSegmentSize = size_t(1) << FirstSegmentSizeBits;
+    // enough segments to cover the whole size_t index range.
+    static const size_t MaxSegments = sizeof(size_t) * 8 - FirstSegmentSizeBits;
+
+    // index based iterator, segments are not contiguous. broken slots are skipped.
+    // a slot at end() may become broken after end() is taken, so an iterator skipping past
+    // the index of end() still compares equal to end().
+    class iterator
+    {
+    public:
+        iterator() :vec(nullptr), index(0), isEnd(false)
+        {
+        }
+
+        iterator(ConcurrentVector* v, size_t i, bool end = false) :vec(v), index(i), isEnd(end)
+        {
+            if (!isEnd)
+            {
+                SkipBroken();
+            }
+        }
+
+        bool operator==(const iterator& other) const
+        {
+            if (isEnd == other.isEnd)
+                return index == other.index;
+
+            return isEnd ? other.index >= index : index >= other.index;
+        }
+
+        bool operator!=(const iterator& other) const
+        {
+            return !(*this == other);
+        }
+
+        T& operator*() const
+        {
+            return (*vec)[index];
+        }
+
+        T* operator->() const
+        {
+            return &(*vec)[index];
+        }
+
+        // pre-increment
+        iterator& operator++()
+        {
+            ++index;
+            SkipBroken();
+            return *this;
+        }
+
+        // post-increment
+        iterator operator++(int)
+        {
+            iterator temp = *this;
+            ++(*this);
+            return temp;
+        }
+
+    private:
+        void SkipBroken()
+        {
+            while (vec->StateOf(index) == SlotBroken)
+            {
+                ++index;
+            }
+        }
+
+    private:
+        ConcurrentVector* vec;
+        size_t index;
+        bool isEnd;
+    };
+
+    /*******************************************************/
+    // ctor and dtor
+    /*******************************************************/
+    ConcurrentVector() :_claimed(0), _size(0)
+    {
+        for (size_t k = 0; k < MaxSegments; ++k)
+        {
+            _segments[k].store(nullptr, std::memory_order_relaxed);
+        }
+    }
+
+    ConcurrentVector(const ConcurrentVector&) = delete;
+    ConcurrentVector& operator=(const ConcurrentVector&) = delete;
+
+    ~ConcurrentVector()
+    {
+        Clear();
+    }
+
+    /*******************************************************/
+    // Capacity
+    /*******************************************************/
+
+    // number of leading finished slots, including broken ones. slots claimed by writers still
+    // constructing, and all slots after them, are not counted yet.
+    size_t Size() const
+    {
+        return _size.load(std::memory_order_acquire);
+    }
+
+    bool Empty() const
+    {
+        return Size() == 0;
+    }
+
+    // number of elements which fit in allocated segments.
+    // segments are allocated in order except under a race, so it counts the leading allocated segments.
+    size_t Capacity() const
+    {
+        size_t k = 0;
+        while (k < MaxSegments && _segments[k].load(std::memory_order_acquire) != nullptr)
+        {
+            ++k;
+        }
+        return SegmentBase(k);
+    }
+
+    // allocate segments to hold newCapacity elements, can be called concurrently with writers.
+    void Reserve(size_t newCapacity)
+    {
+        if (newCapacity == 0)
+            return;
+
+        size_t last = SegmentOf(newCapacity - 1);
+        for (size_t k = 0; k <= last; ++k)
+        {
+            Segment(k);
+        }
+    }
+
+    /*******************************************************/
+    // Modifiers
+    /*******************************************************/
+
+    // appends copy of value, thread-safe. Returns index of the new element.
+    size_t Push_Back(const T& value)
+    {
+        return Emplace_Back(value);
+    }
+
+    size_t Push_Back(T&& value)
+    {
+        return Emplace_Back(std::move(value));
+    }
+
+    // constructs element in-place at the end, thread-safe. Returns index of the new element.
+    // if the constructor throws, the slot is marked broken and the exception is rethrown.
+    template<class... Args>
+    size_t Emplace_Back(Args&&... args)
+    {
+        size_t index = _claimed.fetch_add(1, std::memory_order_relaxed);
+        T* slot = Slot(index);
+        try
+        {
+            GetAlloc().construct(slot, std::forward<Args>(args)...);
+        }
+        catch (...)
+        {
+            Finish(index, SlotBroken);
+            throw;
+        }
+        Finish(index, SlotReady);
+        return index;
+    }
+
+    // appends count copies of value by claiming count slots at once, thread-safe.
+    // Returns index of the first new element, new elements are contiguous in index.
+    // if a copy throws, it and the rest of the claimed slots are marked broken.
+    size_t Grow_By(size_t count, const T& value)
+    {
+        size_t first = _claimed.fetch_add(count, std::memory_order_relaxed);
+        size_t last = first + count;
+        size_t index = first;
+        try
+        {
+            while (index != last)
+            {
+                // fill the part of run within one segment.
+                size_t k = SegmentOf(index);
+                size_t segmentEnd = SegmentBase(k + 1);
+                size_t runEnd = segmentEnd < last ? segmentEnd : last;
+                T* dest = Segment(k) + (index - SegmentBase(k));
+                for (; index != runEnd; ++index, ++dest)
+                {
+                    GetAlloc().construct(dest, value);
+                    Finish(index, SlotReady);
+                }
+            }
+        }
+        catch (...)
+        {
+            for (; index != last; ++index)
+            {
+                if (_segments[SegmentOf(index)].load(std::memory_order_acquire) != nullptr)
+                {
+                    Finish(index, SlotBroken);
+                }
+            }
+            throw;
+        }
+        return first;
+    }
+
+    // appends count value-initialized elements, thread-safe.
+    size_t Grow_By(size_t count)
+    {
+        return Grow_By(count, T());
+    }
+
+    // destroys all elements and frees segments, not thread-safe.
+    void Clear()
+    {
+        for (size_t k = 0; k < MaxSegments; ++k)
+        {
+            T* segment = _segments[k].load(std::memory_order_relaxed);
+            if (segment == nullptr)
+                continue;
+
+            StateType* states = StatesOf(segment, k);
+            for (size_t i = 0; i < SegmentSize(k); ++i)
+            {
+                if (states[i].load(std::memory_order_relaxed) == SlotReady)
+                {
+                    GetAlloc().destroy(segment + i);
+                }
+            }
+            GetAlloc().deallocate(segment, SegmentAllocation(k));
+            _segments[k].store(nullptr, std::memory_order_relaxed);
+        }
+        _claimed.store(0, std::memory_order_relaxed);
+        _size.store(0, std::memory_order_relaxed);
+    }
+
+    /*******************************************************/
+    // Iterators
+    /*******************************************************/
+
+    // specially for "Range for". Need begin(),end().
+    // range is the slots finished when end() is called, broken ones are skipped.
+    iterator begin()
+    {
+        return Begin();
+    }
+
+    iterator end()
+    {
+        return End();
+    }
+
+    iterator Begin()
+    {
+        return iterator(this, 0);
+    }
+
+    iterator End()
+    {
+        return iterator(this, Size(), true);
+    }
+
+    /*******************************************************/
+    // Accessor
+    /*******************************************************/
+
+    // Returns a reference to the element at specified location pos, with bounds checking.
+    // If pos is not within the range of the container or its slot is broken,
+    // an exception of type std::out_of_range is thrown.
+    reference At(size_t pos)
+    {
+        if (pos >= Size())
+            throw std::out_of_range("Error: out of range of concurrent vector.");
+        if (StateOf(pos) == SlotBroken)
+            throw std::out_of_range("Error: element of concurrent vector is broken.");
+
+        return (*this)[pos];
+    }
+
+    // Returns a reference to the element at specified location pos. No bounds checking is performed.
+    reference operator[](size_t pos)
+    {
+        size_t k = SegmentOf(pos);
+        return _segments[k].load(std::memory_order_acquire)[pos - SegmentBase(k)];
+    }
+
+    const_reference operator[](size_t pos) const
+    {
+        size_t k = SegmentOf(pos);
+        return _segments[k].load(std::memory_order_acquire)[pos - SegmentBase(k)];
+    }
+
+private:
+    Alloc& GetAlloc()
+    {
+        return *this;
+    }
+
+    // index of highest set bit, value must not be 0.
+    static size_t HighestBit(size_t value)
+    {
+#if defined(_MSC_VER) && defined(_WIN64)
+        unsigned long bit;
+        _BitScanReverse64(&bit, value);
+        return bit;
+#elif defined(_MSC_VER)
+        unsigned long bit;
+        _BitScanReverse(&bit, value);
+        return bit;
+#else
+        return sizeof(unsigned long long) * 8 - 1 - __builtin_clzll(value);
+#endif
+    }
+
+    static size_t SegmentOf(size_t index)
+    {
+        return HighestBit(index + FirstSegmentSize) - FirstSegmentSizeBits;
+    }
+
+    // index of the first element in segment k.
+    static size_t SegmentBase(size_t k)
+    {
+        return (FirstSegmentSize << k) - FirstSegmentSize;
+    }
+
+    static size_t SegmentSize(size_t k)
+    {
+        return FirstSegmentSize << k;
+    }
+
+    // elements of segment k followed by their state bytes, counted in T.
+    static size_t SegmentAllocation(size_t k)
+    {
+        return SegmentSize(k) + (SegmentSize(k) * sizeof(StateType) + sizeof(T) - 1) / sizeof(T);
+    }
+
+    static StateType* StatesOf(T* segment, size_t k)
+    {
+        return reinterpret_cast<StateType*>(segment + SegmentSize(k));
+    }
+
+    // Returns segment k, allocating it if no one did yet.
+    T* Segment(size_t k)
+    {
+        T* segment = _segments[k].load(std::memory_order_acquire);
+        if (segment != nullptr)
+            return segment;
+
+        T* allocated = GetAlloc().allocate(SegmentAllocation(k));
+        StateType* states = StatesOf(allocated, k);
+        for (size_t i = 0; i < SegmentSize(k); ++i)
+        {
+            ::new((void*)(states + i)) StateType(SlotEmpty);
+        }
+        if (_segments[k].compare_exchange_strong(segment, allocated, std::memory_order_acq_rel, std::memory_order_acquire))
+            return allocated;
+
+        // another writer published segment k first, segment holds it now.
+        GetAlloc().deallocate(allocated, SegmentAllocation(k));
+        return segment;
+    }
+
+    // raw storage of index, segment is allocated if needed.
+    T* Slot(size_t index)
+    {
+        size_t k = SegmentOf(index);
+        return Segment(k) + (index - SegmentBase(k));
+    }
+
+    // state of slot index, empty if its segment is not allocated yet.
+    unsigned char StateOf(size_t index) const
+    {
+        size_t k = SegmentOf(index);
+        T* segment = _segments[k].load(std::memory_order_acquire);
+        if (segment == nullptr)
+            return SlotEmpty;
+
+        return StatesOf(segment, k)[index - SegmentBase(k)].load();
+    }
+
+    // marks slot index ready or broken, then moves Size() over the leading finished slots.
+    // a writer whose slot is not at Size() leaves, the writer finishing the slot at Size() moves on
+    // over it later. state stores and Size() loads are sequentially consistent, so either this writer
+    // sees Size() reach its slot or that writer sees its slot finished.
+    void Finish(size_t index, SlotState state)
+    {
+        size_t k = SegmentOf(index);
+        StatesOf(_segments[k].load(std::memory_order_acquire), k)[index - SegmentBase(k)].store(state);
+
+        size_t size = _size.load();
+        // usual case, own slot is at Size(), no need to look up its state again.
+        if (size == index && _size.compare_exchange_strong(size, index + 1))
+        {
+            size = index + 1;
+        }
+        // slots not claimed yet are empty, so it stops at the claim counter as well.
+        while (StateOf(size) != SlotEmpty)
+        {
+            if (_size.compare_exchange_weak(size, size + 1))
+            {
+                ++size;
+            }
+        }
+    }
+
+private:
+    std::atomic<size_t> _claimed; // claimed slots
+    std::atomic<size_t> _size; // leading finished slots
+    std::atomic<T*> _segments[MaxSegments];
+};
+
+// element whose constructor throws for every value % 7 == 3.
+struct ConcurrentVectorThrowing
+{
+    explicit ConcurrentVectorThrowing(int v) :value(v)
+    {
+        if (v % 7 == 3)
+            throw std::runtime_error("Error: construction of element failed.");
+    }
+
+    int value;
+};
+
+// test routines for concurrent vector
+void TestConcurrentVector()
+{
+    ConcurrentVector<int> vec;
+    vec.Push_Back(1);
+    int& first = vec[0];
+    size_t index = vec.Grow_By(20, 7);
+    cout << "Grow_By first index: " << index << ", size: " << vec.Size() << ", capacity: " << vec.Capacity() << endl;
+    for (int i = 0; i < 100; i++)
+    {
+        vec.Push_Back(i);
+    }
+    // elements never move.
+    assert(&first == &vec[0] && vec[20] == 7 && vec[120] == 99);
+
+    const int threads = 4;
+    const int perThread = 10000;
+    ConcurrentVector<int> shared;
+    std::atomic<bool> writing(true);
+    // reader walks the published elements while writers append, all of them must be constructed.
+    std::thread reader([&shared, &writing, threads, perThread]()
+    {
+        while (writing.load())
+        {
+            for (int value : shared)
+            {
+                assert(value >= 0 && value < threads * perThread);
+            }
+        }
+    });
+    std::vector<std::thread> writers;
+    for (int t = 0; t < threads; t++)
+    {
+        writers.push_back(std::thread([&shared, t, perThread]()
+        {
+            for (int i = 0; i < perThread; i++)
+            {
+                size_t pushed = shared.Push_Back(t * perThread + i);
+                // element is readable by this thread as soon as Push_Back returns.
+                assert(shared[pushed] == t * perThread + i);
+            }
+        }));
+    }
+    for (auto& writer : writers)
+    {
+        writer.join();
+    }
+    writing.store(false);
+    reader.join();
+
+    // each value appears exactly once.
+    std::vector<int> seen(threads * perThread, 0);
+    for (int value : shared)
+    {
+        seen[value]++;
+    }
+    bool once = true;
+    for (int count : seen)
+    {
+        once = once && count == 1;
+    }
+    cout << "concurrent Push_Back size: " << shared.Size() << ", each value once: " << once << endl;
+    assert(once && shared.Size() == threads * perThread);
+
+    // constructors throw under contention, broken slots are skipped and nobody waits on them.
+    ConcurrentVector<ConcurrentVectorThrowing> throwing;
+    std::atomic<int> failed(0);
+    writing.store(true);
+    std::thread throwingReader([&throwing, &writing, threads, perThread]()
+    {
+        while (writing.load())
+        {
+            for (const ConcurrentVectorThrowing& element : throwing)
+            {
+                assert(element.value % 7 != 3 && element.value >= 0 && element.value < threads * perThread);
+            }
+        }
+    });
+    writers.clear();
+    for (int t = 0; t < threads; t++)
+    {
+        writers.push_back(std::thread([&throwing, &failed, t, perThread]()
+        {
+            for (int i = 0; i < perThread; i++)
+            {
+                try
+                {
+                    throwing.Emplace_Back(t * perThread + i);
+                }
+                catch (const std::runtime_error&)
+                {
+                    failed++;
+                }
+            }
+        }));
+    }
+    for (auto& writer : writers)
+    {
+        writer.join();
+    }
+    writing.store(false);
+    throwingReader.join();
+
+    std::vector<int> constructed(threads * perThread, 0);
+    size_t brokenIndex = throwing.Size();
+    for (size_t i = 0; i < throwing.Size(); i++)
+    {
+        try
+        {
+            constructed[throwing.At(i).value]++;
+        }
+        catch (const std::out_of_range&)
+        {
+            brokenIndex = i;
+        }
+    }
+    size_t iterated = 0;
+    for (const ConcurrentVectorThrowing& element : throwing)
+    {
+        iterated++;
+        assert(element.value % 7 != 3);
+    }
+    bool expected = true;
+    for (int v = 0; v < threads * perThread; v++)
+    {
+        expected = expected && constructed[v] == (v % 7 == 3 ? 0 : 1);
+    }
+    cout << "throwing Emplace_Back size: " << throwing.Size() << ", failed: " << failed.load()
+        << ", iterated: " << iterated << ", each constructed value once: " << expected << endl;
+    assert(expected && throwing.Size() == threads * perThread && brokenIndex < throwing.Size());
+    assert(iterated + failed.load() == throwing.Size());
+
+    cout << "end of test ConcurrentVector." << endl;
+}
+
+#endif
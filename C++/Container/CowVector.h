@@ -0,0 +1,279 @@
+//**************************************************************
+//         copy-on-write vector sharing its buffer between copies
+//**************************************************************
+
+#ifndef COWVECTOR_H
+#define COWVECTOR_H
+
+#include <cassert>
+#include <iostream>
+#include <stdexcept>
+#include <thread>
+#include <utility>
+#include <vector>
+#include "Vector.h"
+#include "..\SmartPointer\SharedPtr.h"
+
+using namespace std;
+
+// copying a Vector copies all elements, O(n) per snapshot.
+// CowVector copies share one Vector through SharedPtr, so a copy only increases a reference count.
+// the shared Vector is never modified: a writer first detaches, i.e. makes its own copy of the
+// elements if any other CowVector still shares them, and then modifies its own copy.
+// a snapshot is an ordinary copy: it keeps seeing the elements at the time it was taken,
+// whatever the writer does later, and it can be read in another thread without lock since
+// reference counts of SharedPtr are atomic.
+//
+// NOTE:
+// 1. one CowVector object must not be used by several threads at once(as any Vector),
+//    give each thread its own copy instead, copies are cheap.
+// 2. references from a read accessor are invalidated by the next write through the same object,
+//    since the write could detach to a new buffer.
+template<typename T>
+class CowVector
+{
+public:
+    typedef const T* const_iterator;
+    typedef const T& const_reference;
+
+    /*******************************************************/
+    // ctor and dtor
+    /*******************************************************/
+
+    // empty CowVector shares nothing, buffer is created on first write.
+    CowVector()
+    {
+    }
+
+    CowVector(size_t count, const T& value) :data(new Vector<T>(count, value))
+    {
+    }
+
+    explicit CowVector(const Vector<T>& vec) :data(new Vector<T>(vec))
+    {
+    }
+
+    explicit CowVector(Vector<T>&& vec) :data(new Vector<T>(std::move(vec)))
+    {
+    }
+
+    // O(1), shares buffer of other.
+    CowVector(const CowVector& other) :data(other.data)
+    {
+    }
+
+    CowVector(CowVector&& other) :data(std::move(other.data))
+    {
+    }
+
+    CowVector& operator=(const CowVector& other)
+    {
+        data = other.data;
+        return *this;
+    }
+
+    CowVector& operator=(CowVector&& other)
+    {
+        data = std::move(other.data);
+        return *this;
+    }
+
+    /*******************************************************/
+    // Capacity
+    /*******************************************************/
+    bool Empty() const
+    {
+        return Size() == 0;
+    }
+
+    size_t Size() const
+    {
+        return data.Get() == nullptr ? 0 : data.Get()->Size();
+    }
+
+    // whether buffer is shared with other CowVectors, so next write will copy it.
+    bool IsShared() const
+    {
+        return data.UseCount() > 1;
+    }
+
+    /*******************************************************/
+    // Modifiers
+    /*******************************************************/
+
+    // replaces element at pos, detaching firstly if buffer is shared.
+    void Set(size_t pos, const T& value)
+    {
+        Mutable()[pos] = value;
+    }
+
+    void Push_Back(const T& value)
+    {
+        Mutable().Push_Back(value);
+    }
+
+    void Push_Back(T&& value)
+    {
+        Mutable().Push_Back(std::move(value));
+    }
+
+    template<class... Args>
+    void Emplace_Back(Args&&... args)
+    {
+        Mutable().Emplace_Back(std::forward<Args>(args)...);
+    }
+
+    void Pop_Back()
+    {
+        Mutable().Pop_back();
+    }
+
+    // clearing a shared buffer just drops this reference to it.
+    void Clear()
+    {
+        if (IsShared())
+            data.Reset();
+        else if (data.Get() != nullptr)
+            data.Get()->Clear();
+    }
+
+    // Returns the Vector owned only by this CowVector to modify it by whole Vector API.
+    // buffer is copied if it is shared, other copies never see the modification.
+    Vector<T>& Mutable()
+    {
+        if (data.Get() == nullptr)
+        {
+            data = SharedPtr<Vector<T>>(new Vector<T>());
+        }
+        else if (!data.Unique())
+        {
+            data = SharedPtr<Vector<T>>(new Vector<T>(*data.Get()));
+        }
+        return *data.Get();
+    }
+
+    /*******************************************************/
+    // Iterators
+    /*******************************************************/
+
+    // specially for "Range for". Need begin(),end().
+    const_iterator begin() const
+    {
+        return Begin();
+    }
+
+    const_iterator end() const
+    {
+        return End();
+    }
+
+    const_iterator Begin() const
+    {
+        return data.Get() == nullptr ? nullptr : data.Get()->Begin();
+    }
+
+    const_iterator End() const
+    {
+        return data.Get() == nullptr ? nullptr : data.Get()->End();
+    }
+
+    /*******************************************************/
+    // Accessor
+    /*******************************************************/
+
+    // Returns a reference to the element at specified location pos, with bounds checking.
+    // If pos is not within the range of the container, an exception of type std::out_of_range is thrown.
+    const_reference At(size_t pos) const
+    {
+        if (pos >= Size())
+            throw std::out_of_range("Error: out of range of cow vector.");
+
+        return Begin()[pos];
+    }
+
+    // Returns a reference to the element at specified location pos. No bounds checking is performed.
+    // it is read-only, use Set or Mutable to modify elements.
+    const_reference operator[](size_t pos) const
+    {
+        return Begin()[pos];
+    }
+
+    const_reference Front() const
+    {
+        return Begin()[0];
+    }
+
+    const_reference Back() const
+    {
+        return End()[-1];
+    }
+
+private:
+    SharedPtr<Vector<T>> data; // never modified while shared
+};
+
+// test routines for copy-on-write vector
+void TestCowVector()
+{
+    CowVector<int> vec1;
+    for (int i = 0; i < 5; i++)
+    {
+        vec1.Push_Back(i);
+    }
+
+    // copy shares buffer.
+    CowVector<int> vec2(vec1);
+    assert(vec1.IsShared() && vec1.Begin() == vec2.Begin());
+
+    // write detaches, the copy keeps old elements.
+    vec1.Set(0, 100);
+    vec1.Push_Back(5);
+    assert(!vec1.IsShared() && !vec2.IsShared() && vec1.Begin() != vec2.Begin());
+    for (int v : vec1)
+    {
+        cout << v << " ";
+    }
+    cout << "| ";
+    for (int v : vec2)
+    {
+        cout << v << " ";
+    }
+    cout << endl;
+
+    // not shared any more, write in place.
+    const int* first = vec1.Begin();
+    vec1.Set(1, 101);
+    assert(vec1.Begin() == first);
+
+    // readers take snapshots in other threads while writer keeps modifying its own copy.
+    CowVector<int> live(1000, 0);
+    std::vector<std::thread> readers;
+    for (int t = 0; t < 4; t++)
+    {
+        CowVector<int> snapshot(live);
+        readers.push_back(std::thread([snapshot]()
+        {
+            // all elements of a snapshot are equal, the writer never changes a shared buffer.
+            for (int round = 0; round < 100; round++)
+            {
+                for (size_t i = 0; i < snapshot.Size(); i++)
+                {
+                    assert(snapshot[i] == snapshot[0]);
+                }
+            }
+        }));
+        for (size_t i = 0; i < live.Size(); i++)
+        {
+            live.Set(i, t + 1);
+        }
+    }
+    for (auto& reader : readers)
+    {
+        reader.join();
+    }
+    assert(!live.IsShared() && live[999] == 4);
+
+    cout << "end of test CowVector." << endl;
+}
+
+#endif
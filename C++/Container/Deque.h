@@ -0,0 +1,671 @@
+//**************************************************************
+//         std::deque alike container of fixed-size blocks
+//**************************************************************
+
+#ifndef DEQUE_H
+#define DEQUE_H
+
+#include <cassert>
+#include <cstddef>
+#include <cstring>
+#include <deque>
+#include <iostream>
+#include <iterator>
+#include <stdexcept>
+#include <string>
+#include <utility>
+#include "..\Memory\Allocator.h"
+
+using namespace std;
+
+// Deque stores elements in fixed-size blocks, a map(array of block pointers) keeps blocks in order:
+//
+//   map:    [null][ b0 ][ b1 ][ b2 ][null]
+//   blocks:        [..xx][xxxx][xx..]        x: element, .: raw slot
+//
+// push/pop at either end only touches the first or last block, a new block is allocated every
+// BlockSize pushes, and elements are never moved, so references stay valid after push/pop at ends.
+// element i is block (start + i) / BlockSize, slot (start + i) % BlockSize, both are shifts since
+// BlockSize is a power of 2, so random access is O(1) as well.
+// compared with List it has no per element node allocation and no prev/next pointers,
+// elements of a block are contiguous and scanning them is cache friendly.
+
+// largest power of 2 not greater than N(1 for 0).
+template<size_t N>
+struct FloorPowerOfTwo
+{
+    static const size_t value = FloorPowerOfTwo<N / 2>::value * 2;
+};
+
+template<>
+struct FloorPowerOfTwo<1>
+{
+    static const size_t value = 1;
+};
+
+template<>
+struct FloorPowerOfTwo<0>
+{
+    static const size_t value = 1;
+};
+
+// number of elements per block: blocks of 4KB(one page), but at least 16 elements for large types.
+template<typename T>
+struct DequeBlockSize
+{
+    static const size_t value = (4096 / sizeof(T) > 16) ? FloorPowerOfTwo<4096 / sizeof(T)>::value : 16;
+};
+
+// deque iterator walks a block by pointer and jumps to the next block through the map.
+// map has one null slot after its end, so stepping past the last block reads null instead of overflowing.
+// slots of the map out of elements are null, the only iterator which can point into them is end(),
+// whose cur is then null as well.
+template<typename T, size_t BlockSize>
+class deque_iterator
+{
+public:
+    typedef std::random_access_iterator_tag iterator_category;
+    typedef T value_type;
+    typedef ptrdiff_t difference_type;
+    typedef T* pointer;
+    typedef T& reference;
+
+    deque_iterator() :cur(nullptr), first(nullptr), node(nullptr)
+    {
+    }
+
+    deque_iterator(T* c, T** n) :cur(c), first(n == nullptr ? nullptr : *n), node(n)
+    {
+    }
+
+    bool operator==(const deque_iterator& other) const
+    {
+        return cur == other.cur;
+    }
+
+    bool operator!=(const deque_iterator& other) const
+    {
+        return cur != other.cur;
+    }
+
+    bool operator<(const deque_iterator& other) const
+    {
+        return (*this - other) < 0;
+    }
+
+    reference operator*() const
+    {
+        return *cur;
+    }
+
+    pointer operator->() const
+    {
+        return cur;
+    }
+
+    reference operator[](difference_type n) const
+    {
+        return *(*this + n);
+    }
+
+    // pre-increment
+    deque_iterator& operator++()
+    {
+        ++cur;
+        if (cur == first + BlockSize)
+        {
+            ++node;
+            first = cur = *node;
+        }
+        return *this;
+    }
+
+    // post-increment
+    deque_iterator operator++(int)
+    {
+        deque_iterator temp = *this;
+        ++(*this);
+        return temp;
+    }
+
+    // pre-decrement
+    deque_iterator& operator--()
+    {
+        if (cur == first)
+        {
+            --node;
+            first = *node;
+            cur = first + BlockSize;
+        }
+        --cur;
+        return *this;
+    }
+
+    // post-decrement
+    deque_iterator operator--(int)
+    {
+        deque_iterator temp = *this;
+        --(*this);
+        return temp;
+    }
+
+    deque_iterator& operator+=(difference_type n)
+    {
+        difference_type offset = (cur - first) + n;
+        if (offset >= 0 && offset < difference_type(BlockSize))
+        {
+            cur += n;
+        }
+        else
+        {
+            difference_type nodeOffset = offset > 0 ? offset / difference_type(BlockSize)
+                : -difference_type((-offset - 1) / BlockSize) - 1;
+            node += nodeOffset;
+            first = *node;
+            cur = first + (offset - nodeOffset * difference_type(BlockSize));
+        }
+        return *this;
+    }
+
+    deque_iterator& operator-=(difference_type n)
+    {
+        return *this += -n;
+    }
+
+    deque_iterator operator+(difference_type n) const
+    {
+        deque_iterator temp = *this;
+        return temp += n;
+    }
+
+    deque_iterator operator-(difference_type n) const
+    {
+        deque_iterator temp = *this;
+        return temp -= n;
+    }
+
+    difference_type operator-(const deque_iterator& other) const
+    {
+        return (node - other.node) * difference_type(BlockSize) + (cur - first) - (other.cur - other.first);
+    }
+
+public:
+    T* cur; // current element
+    T* first; // first slot of current block
+    T** node; // slot of current block in map
+};
+
+template<typename T, typename Alloc = Allocator<T>>
+class Deque : private Alloc
+{
+public:
+    static const size_t BlockSize = DequeBlockSize<T>::value;
+
+    typedef deque_iterator<T, BlockSize> iterator;
+    typedef T value_type;
+    typedef T& reference;
+    typedef const T& const_reference;
+    typedef Alloc allocator_type;
+
+    /*******************************************************/
+    // ctor and dtor
+    /*******************************************************/
+    Deque() :_map(nullptr), _mapSize(0), _start(0), _size(0), _spare(nullptr)
+    {
+    }
+
+    Deque(size_t count, const T& value) :_map(nullptr), _mapSize(0), _start(0), _size(0), _spare(nullptr)
+    {
+        for (; count > 0; --count)
+        {
+            Push_Back(value);
+        }
+    }
+
+    explicit Deque(size_t count) :_map(nullptr), _mapSize(0), _start(0), _size(0), _spare(nullptr)
+    {
+        for (; count > 0; --count)
+        {
+            Emplace_Back();
+        }
+    }
+
+    Deque(const Deque& other) :Alloc(other), _map(nullptr), _mapSize(0), _start(0), _size(0), _spare(nullptr)
+    {
+        for (size_t i = 0; i < other.Size(); ++i)
+        {
+            Push_Back(other[i]);
+        }
+    }
+
+    Deque(Deque&& other) :Alloc(std::move(other)), _map(nullptr), _mapSize(0), _start(0), _size(0), _spare(nullptr)
+    {
+        SwapStorage(other);
+    }
+
+    ~Deque()
+    {
+        Clear();
+        if (_spare != nullptr)
+        {
+            GetAlloc().deallocate(_spare, BlockSize);
+        }
+        if (_map != nullptr)
+        {
+            MapAllocator(GetAlloc()).deallocate(_map, _mapSize + 1);
+        }
+    }
+
+    Deque& operator=(const Deque& other)
+    {
+        if (this != &other)
+        {
+            // map and spare block of this deque are reused.
+            Clear();
+            for (size_t i = 0; i < other.Size(); ++i)
+            {
+                Push_Back(other[i]);
+            }
+        }
+        return *this;
+    }
+
+    Deque& operator=(Deque&& other)
+    {
+        if (this != &other)
+        {
+            Deque temp(std::move(other));
+            Swap(temp);
+        }
+        return *this;
+    }
+
+    /*******************************************************/
+    // Capacity
+    /*******************************************************/
+    bool Empty() const
+    {
+        return _size == 0;
+    }
+
+    size_t Size() const
+    {
+        return _size;
+    }
+
+    /*******************************************************/
+    // Modifiers
+    /*******************************************************/
+
+    // destroys all elements and frees their blocks, map is kept for reuse.
+    void Clear()
+    {
+        while (!Empty())
+        {
+            Pop_Back();
+        }
+    }
+
+    void Push_Back(const T& value)
+    {
+        Emplace_Back(value);
+    }
+
+    void Push_Back(T&& value)
+    {
+        Emplace_Back(std::move(value));
+    }
+
+    void Push_Front(const T& value)
+    {
+        Emplace_Front(value);
+    }
+
+    void Push_Front(T&& value)
+    {
+        Emplace_Front(std::move(value));
+    }
+
+    // constructs an element in-place at the end.
+    // Returns a reference to the inserted element.
+    template<class... Args>
+    reference Emplace_Back(Args&&... args)
+    {
+        if (_start + _size == _mapSize * BlockSize)
+        {
+            GrowMap();
+        }
+
+        T* slot = ConstructAt(_start + _size, std::forward<Args>(args)...);
+        ++_size;
+        return *slot;
+    }
+
+    // constructs an element in-place at the beginning.
+    // Returns a reference to the inserted element.
+    template<class... Args>
+    reference Emplace_Front(Args&&... args)
+    {
+        if (_start == 0)
+        {
+            GrowMap();
+        }
+
+        T* slot = ConstructAt(_start - 1, std::forward<Args>(args)...);
+        --_start;
+        ++_size;
+        return *slot;
+    }
+
+    // removes the last element, calling it on an empty deque is undefined.
+    void Pop_Back()
+    {
+        size_t pos = _start + _size - 1;
+        --_size;
+        DestroyAt(pos, pos % BlockSize == 0 || _size == 0);
+    }
+
+    // removes the first element, calling it on an empty deque is undefined.
+    void Pop_Front()
+    {
+        size_t pos = _start;
+        ++_start;
+        --_size;
+        DestroyAt(pos, _start % BlockSize == 0 || _size == 0);
+    }
+
+    void Swap(Deque& other)
+    {
+        // storage goes with the allocator owning it.
+        std::swap(GetAlloc(), other.GetAlloc());
+        SwapStorage(other);
+    }
+
+    /*******************************************************/
+    // Iterators
+    /*******************************************************/
+
+    // specially for "Range for". Need begin(),end().
+    iterator begin()
+    {
+        return Begin();
+    }
+
+    iterator end()
+    {
+        return End();
+    }
+
+    iterator Begin()
+    {
+        return IteratorAt(_start);
+    }
+
+    iterator End()
+    {
+        return IteratorAt(_start + _size);
+    }
+
+    /*******************************************************/
+    // Accessor
+    /*******************************************************/
+
+    // Returns a reference to the element at specified location pos, with bounds checking.
+    // If pos is not within the range of the container, an exception of type std::out_of_range is thrown.
+    reference At(size_t pos)
+    {
+        if (pos >= Size())
+            throw std::out_of_range("Error: out of range of deque.");
+
+        return (*this)[pos];
+    }
+
+    // Returns a reference to the element at specified location pos. No bounds checking is performed.
+    reference operator[](size_t pos)
+    {
+        size_t index = _start + pos;
+        return _map[index / BlockSize][index % BlockSize];
+    }
+
+    const_reference operator[](size_t pos) const
+    {
+        size_t index = _start + pos;
+        return _map[index / BlockSize][index % BlockSize];
+    }
+
+    // Returns a reference to the first element in the container.
+    // Calling front on an empty container is undefined.
+    reference Front()
+    {
+        return (*this)[0];
+    }
+
+    // Returns reference to the last element in the container.
+    // Calling back on an empty container is undefined.
+    reference Back()
+    {
+        return (*this)[_size - 1];
+    }
+
+private:
+    typedef typename Alloc::template rebind<T*>::other MapAllocator;
+
+    Alloc& GetAlloc()
+    {
+        return *this;
+    }
+
+    // swap elements and storage, but not allocators.
+    void SwapStorage(Deque& other)
+    {
+        std::swap(_map, other._map);
+        std::swap(_mapSize, other._mapSize);
+        std::swap(_start, other._start);
+        std::swap(_size, other._size);
+        std::swap(_spare, other._spare);
+    }
+
+    iterator IteratorAt(size_t index)
+    {
+        if (_map == nullptr)
+            return iterator();
+
+        T** node = _map + index / BlockSize;
+        return iterator(*node == nullptr ? nullptr : *node + index % BlockSize, node);
+    }
+
+    // a block is allocated when the first element goes into it and freed when its last element goes away.
+    // one freed block is kept as spare, so a queue which pushes at back and pops at front
+    // does not hit the allocator every BlockSize elements.
+    T* AllocBlock()
+    {
+        if (_spare != nullptr)
+        {
+            T* block = _spare;
+            _spare = nullptr;
+            return block;
+        }
+        return GetAlloc().allocate(BlockSize);
+    }
+
+    void DeallocBlock(T* block)
+    {
+        if (_spare == nullptr)
+        {
+            _spare = block;
+        }
+        else
+        {
+            GetAlloc().deallocate(block, BlockSize);
+        }
+    }
+
+    // construct element at global slot index, allocating its block if needed.
+    template<class... Args>
+    T* ConstructAt(size_t index, Args&&... args)
+    {
+        T*& block = _map[index / BlockSize];
+        bool newBlock = block == nullptr;
+        if (newBlock)
+        {
+            block = AllocBlock();
+        }
+
+        T* slot = block + index % BlockSize;
+        try
+        {
+            GetAlloc().construct(slot, std::forward<Args>(args)...);
+        }
+        catch (...)
+        {
+            if (newBlock)
+            {
+                DeallocBlock(block);
+                block = nullptr;
+            }
+            throw;
+        }
+        return slot;
+    }
+
+    // destroy element at global slot index, free its block if it has no element any more.
+    void DestroyAt(size_t index, bool releaseBlock)
+    {
+        T*& block = _map[index / BlockSize];
+        GetAlloc().destroy(block + index % BlockSize);
+        if (releaseBlock)
+        {
+            DeallocBlock(block);
+            block = nullptr;
+        }
+    }
+
+    // make room for at least one more block at both ends of map.
+    // if map is less than half used, used blocks are just re-centered in place,
+    // otherwise map is doubled. only block pointers are moved, elements never.
+    void GrowMap()
+    {
+        size_t firstBlock = _start / BlockSize;
+        size_t usedBlocks = _size == 0 ? 0 : (_start + _size - 1) / BlockSize - firstBlock + 1;
+
+        T** map = _map;
+        size_t mapSize = _mapSize;
+        if (usedBlocks * 2 >= _mapSize)
+        {
+            mapSize = _mapSize < 4 ? 8 : _mapSize * 2;
+            // one more null slot after end for iterator, see deque_iterator.
+            map = MapAllocator(GetAlloc()).allocate(mapSize + 1);
+        }
+
+        size_t newFirstBlock = (mapSize - usedBlocks) / 2;
+        if (usedBlocks > 0)
+        {
+            std::memmove(map + newFirstBlock, _map + firstBlock, usedBlocks * sizeof(T*));
+        }
+        // null all other slots.
+        for (size_t i = 0; i < newFirstBlock; ++i)
+        {
+            map[i] = nullptr;
+        }
+        for (size_t i = newFirstBlock + usedBlocks; i <= mapSize; ++i)
+        {
+            map[i] = nullptr;
+        }
+
+        if (map != _map && _map != nullptr)
+        {
+            MapAllocator(GetAlloc()).deallocate(_map, _mapSize + 1);
+        }
+        _map = map;
+        _mapSize = mapSize;
+        _start = newFirstBlock * BlockSize + (_size == 0 ? BlockSize / 2 : _start % BlockSize);
+    }
+
+private:
+    T** _map; // block pointers, _mapSize + 1 slots
+    size_t _mapSize;
+    size_t _start; // slot index of the first element, counted from the first slot of map
+    size_t _size;
+    T* _spare; // free block kept for reuse
+};
+
+// test routines for deque
+void TestDeque()
+{
+    Deque<int> deque1;
+    for (int i = 0; i < 5; i++)
+    {
+        deque1.Push_Back(i);
+        deque1.Push_Front(-i);
+    }
+    for (auto v : deque1)
+    {
+        cout << v << " ";
+    }
+    cout << endl;
+
+    deque1.Pop_Front();
+    deque1.Pop_Back();
+    cout << "Front: " << deque1.Front() << ", Back: " << deque1.Back() << ", [3]: " << deque1[3] << ", size: " << deque1.Size() << endl;
+
+    // compare with std::deque across many blocks, both ends.
+    Deque<int> deque2;
+    std::deque<int> expected;
+    for (int i = 0; i < 100000; i++)
+    {
+        switch (i % 5)
+        {
+        case 0:
+        case 1:
+            deque2.Push_Back(i);
+            expected.push_back(i);
+            break;
+        case 2:
+            deque2.Push_Front(i);
+            expected.push_front(i);
+            break;
+        case 3:
+            deque2.Pop_Front();
+            expected.pop_front();
+            break;
+        default:
+            if (i % 3 == 0)
+            {
+                deque2.Push_Front(i);
+                expected.push_front(i);
+            }
+            break;
+        }
+    }
+    bool same = deque2.Size() == expected.size() && std::equal(deque2.Begin(), deque2.End(), expected.begin());
+    for (size_t i = 0; i < expected.size(); i += 997)
+    {
+        same = same && deque2[i] == expected[i];
+    }
+    cout << "same as std::deque: " << same << endl;
+    assert(same);
+
+    // random access iterator.
+    Deque<int>::iterator middle = deque2.Begin() + deque2.Size() / 2;
+    assert(middle - deque2.Begin() == ptrdiff_t(deque2.Size() / 2) && *middle == expected[expected.size() / 2]);
+    assert(deque2.End() - deque2.Begin() == ptrdiff_t(deque2.Size()));
+
+    // references stay valid after push at both ends.
+    int& front = deque2.Front();
+    for (int i = 0; i < 10000; i++)
+    {
+        deque2.Push_Front(i);
+        deque2.Push_Back(i);
+    }
+    assert(&front == &deque2[10000]);
+
+    Deque<string> deque3(3, "abc");
+    Deque<string> deque4(deque3);
+    deque4.Push_Front("front");
+    deque3 = deque4;
+    cout << "deque of string: " << deque3.Front() << " " << deque3.Back() << ", size: " << deque3.Size() << endl;
+
+    cout << "end of test Deque." << endl;
+}
+
+#endif
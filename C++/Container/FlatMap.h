@@ -0,0 +1,418 @@
+//**************************************************************
+//         std::map alike container built on sorted Vector
+//**************************************************************
+
+#ifndef FLATMAP_H
+#define FLATMAP_H
+
+#include <algorithm>
+#include <cassert>
+#include <functional>
+#include <iostream>
+#include <stdexcept>
+#include <utility>
+#include "Vector.h"
+#include "FlatSet.h"
+
+using namespace std;
+
+// FlatMap keeps sorted keys and their values in two separate Vectors, values[i] belongs to keys[i].
+// binary search only touches the key array, so more keys fit in cache lines than with
+// pairs of key and value stored together. see FlatSet for the trade-off against node based map.
+
+// flat map iterator walks keys and values together.
+// dereference gives pair of references, key is const since keys must stay sorted.
+template<typename K, typename V>
+class flat_map_iterator
+{
+public:
+    typedef std::pair<const K&, V&> reference;
+
+    flat_map_iterator() :key(nullptr), value(nullptr)
+    {
+    }
+
+    flat_map_iterator(const K* k, V* v) :key(k), value(v)
+    {
+    }
+
+    bool operator==(const flat_map_iterator& other) const
+    {
+        return key == other.key;
+    }
+
+    bool operator!=(const flat_map_iterator& other) const
+    {
+        return key != other.key;
+    }
+
+    reference operator*() const
+    {
+        return reference(*key, *value);
+    }
+
+    const K& Key() const
+    {
+        return *key;
+    }
+
+    V& Value() const
+    {
+        return *value;
+    }
+
+    // pre-increment
+    flat_map_iterator& operator++()
+    {
+        ++key;
+        ++value;
+        return *this;
+    }
+
+    // post-increment
+    flat_map_iterator operator++(int)
+    {
+        flat_map_iterator temp = *this;
+        ++(*this);
+        return temp;
+    }
+
+public:
+    const K* key; // make it public for FlatMap
+    V* value;
+};
+
+template<typename K, typename V, typename Compare = std::less<K>>
+class FlatMap
+{
+public:
+    typedef flat_map_iterator<K, V> iterator;
+
+    /*******************************************************/
+    // ctor and dtor
+    /*******************************************************/
+    FlatMap()
+    {
+    }
+
+    template<typename InputIt>
+    FlatMap(InputIt first, InputIt last)
+    {
+        Insert(first, last);
+    }
+
+    /*******************************************************/
+    // Capacity
+    /*******************************************************/
+    bool Empty() const
+    {
+        return keys.Empty();
+    }
+
+    size_t Size() const
+    {
+        return keys.Size();
+    }
+
+    void Reserve(size_t newCapacity)
+    {
+        keys.Reserve(newCapacity);
+        values.Reserve(newCapacity);
+    }
+
+    /*******************************************************/
+    // Lookup
+    /*******************************************************/
+
+    // Returns iterator to the first element whose key is not less than key.
+    iterator LowerBound(const K& key)
+    {
+        return IteratorAt(LowerBoundIndex(key));
+    }
+
+    // Returns iterator to element with key, or End() if there is no such element.
+    iterator Find(const K& key)
+    {
+        size_t index = LowerBoundIndex(key);
+        return IsKeyAt(index, key) ? IteratorAt(index) : End();
+    }
+
+    bool Contains(const K& key) const
+    {
+        return IsKeyAt(LowerBoundIndex(key), key);
+    }
+
+    size_t Count(const K& key) const
+    {
+        return Contains(key) ? 1 : 0;
+    }
+
+    // Returns a reference to the value of key, with bounds checking.
+    // If no such element exists, an exception of type std::out_of_range is thrown.
+    V& At(const K& key)
+    {
+        size_t index = LowerBoundIndex(key);
+        if (!IsKeyAt(index, key))
+            throw std::out_of_range("Error: key is not in flat map.");
+
+        return values[index];
+    }
+
+    // Returns a reference to the value of key, value-initialized value is inserted if key does not exist.
+    V& operator[](const K& key)
+    {
+        size_t index = LowerBoundIndex(key);
+        if (!IsKeyAt(index, key))
+        {
+            InsertAt(index, key);
+        }
+
+        return values[index];
+    }
+
+    /*******************************************************/
+    // Modifiers
+    /*******************************************************/
+
+    void Clear()
+    {
+        keys.Clear();
+        values.Clear();
+    }
+
+    // inserts key and value if key is not there yet, O(n) since elements after it are shifted.
+    // Returns iterator to the element and whether insertion took place.
+    std::pair<iterator, bool> Insert(const K& key, const V& value)
+    {
+        size_t index = LowerBoundIndex(key);
+        if (IsKeyAt(index, key))
+            return std::make_pair(IteratorAt(index), false);
+
+        InsertAt(index, key, value);
+        return std::make_pair(IteratorAt(index), true);
+    }
+
+    // inserts elements in range [first, last) whose keys are not there yet.
+    // element of range should have first(key) and second(value) as std::pair.
+    // if a key occurs several times in range, the first one is inserted as std::map.
+    // new elements are sorted and merged with old elements once, O(n + m log m) rather than O(n * m).
+    template<typename InputIt>
+    void Insert(InputIt first, InputIt last)
+    {
+        typedef std::pair<K, V> Item;
+        Vector<Item> items;
+        for (; first != last; ++first)
+        {
+            items.Emplace_Back(first->first, first->second);
+        }
+        if (items.Empty())
+            return;
+
+        // stable sort so the first occurrence of duplicated keys stays in front, and unique keeps it.
+        Compare less = comp;
+        std::stable_sort(items.Begin(), items.End(), [less](const Item& a, const Item& b) { return less(a.first, b.first); });
+        items.Erase(std::unique(items.Begin(), items.End(), [less](const Item& a, const Item& b) { return !less(a.first, b.first); }), items.End());
+
+        // merge two sorted sequences into new key and value arrays, element already in map wins.
+        Vector<K> mergedKeys;
+        Vector<V> mergedValues;
+        mergedKeys.Reserve(keys.Size() + items.Size());
+        mergedValues.Reserve(keys.Size() + items.Size());
+        size_t oldIndex = 0;
+        Item* newItem = items.Begin();
+        while (oldIndex < keys.Size() && newItem != items.End())
+        {
+            if (comp(newItem->first, keys[oldIndex]))
+            {
+                mergedKeys.Push_Back(std::move(newItem->first));
+                mergedValues.Push_Back(std::move(newItem->second));
+                ++newItem;
+            }
+            else
+            {
+                if (!comp(keys[oldIndex], newItem->first))
+                    ++newItem; // equal key
+                mergedKeys.Push_Back(std::move(keys[oldIndex]));
+                mergedValues.Push_Back(std::move(values[oldIndex]));
+                ++oldIndex;
+            }
+        }
+        for (; oldIndex < keys.Size(); ++oldIndex)
+        {
+            mergedKeys.Push_Back(std::move(keys[oldIndex]));
+            mergedValues.Push_Back(std::move(values[oldIndex]));
+        }
+        for (; newItem != items.End(); ++newItem)
+        {
+            mergedKeys.Push_Back(std::move(newItem->first));
+            mergedValues.Push_Back(std::move(newItem->second));
+        }
+
+        keys = std::move(mergedKeys);
+        values = std::move(mergedValues);
+    }
+
+    // Returns number of erased elements(0 or 1).
+    size_t Erase(const K& key)
+    {
+        size_t index = LowerBoundIndex(key);
+        if (!IsKeyAt(index, key))
+            return 0;
+
+        keys.Erase(keys.Begin() + index);
+        values.Erase(values.Begin() + index);
+        return 1;
+    }
+
+    // Returns iterator following the erased element.
+    iterator Erase(iterator pos)
+    {
+        size_t index = pos.key - keys.Begin();
+        keys.Erase(keys.Begin() + index);
+        values.Erase(values.Begin() + index);
+        return IteratorAt(index);
+    }
+
+    /*******************************************************/
+    // Iterators
+    /*******************************************************/
+
+    // specially for "Range for". Need begin(),end().
+    iterator begin()
+    {
+        return Begin();
+    }
+
+    iterator end()
+    {
+        return End();
+    }
+
+    iterator Begin()
+    {
+        return IteratorAt(0);
+    }
+
+    iterator End()
+    {
+        return IteratorAt(keys.Size());
+    }
+
+    /*******************************************************/
+    // Accessor
+    /*******************************************************/
+
+    // sorted keys, e.g. to scan them with VectorAlgorithm.
+    const Vector<K>& Keys() const
+    {
+        return keys;
+    }
+
+    // values in the order of keys.
+    const Vector<V>& Values() const
+    {
+        return values;
+    }
+
+private:
+    size_t LowerBoundIndex(const K& key) const
+    {
+        return BranchlessLowerBound<K>(keys.Begin(), keys.Size(), key, comp) - keys.Begin();
+    }
+
+    bool IsKeyAt(size_t index, const K& key) const
+    {
+        return index != keys.Size() && !comp(key, keys.Begin()[index]);
+    }
+
+    iterator IteratorAt(size_t index)
+    {
+        return iterator(keys.Begin() + index, values.Begin() + index);
+    }
+
+    // inserts key and value constructed from args at index.
+    // if the value throws, the key is erased again so keys and values stay in step.
+    template<typename... Args>
+    void InsertAt(size_t index, const K& key, Args&&... args)
+    {
+        keys.Insert(keys.Begin() + index, key);
+        try
+        {
+            values.Emplace(values.Begin() + index, std::forward<Args>(args)...);
+        }
+        catch (...)
+        {
+            keys.Erase(keys.Begin() + index);
+            throw;
+        }
+    }
+
+private:
+    Vector<K> keys; // sorted and unique
+    Vector<V> values; // values[i] is value of keys[i]
+    Compare comp;
+};
+
+// test routines for flat map
+void TestFlatMap()
+{
+    FlatMap<int, string> map1;
+    map1.Insert(3, "three");
+    map1.Insert(1, "one");
+    map1.Insert(3, "THREE"); // key exists, not inserted.
+    map1[2] = "two";
+
+    std::pair<int, string> items[] = { std::make_pair(5, "five"), std::make_pair(0, "zero"), std::make_pair(1, "ONE"), std::make_pair(5, "FIVE") };
+    map1.Insert(items, items + 4);
+
+    for (auto item : map1)
+    {
+        cout << item.first << ":" << item.second << " ";
+    }
+    cout << endl;
+
+    cout << "At(5): " << map1.At(5) << ", contains 4: " << map1.Contains(4) << endl;
+    cout << "find 2: " << map1.Find(2).Value() << endl;
+
+    map1.Erase(3);
+    map1.Erase(map1.Begin());
+    for (auto item : map1)
+    {
+        cout << item.first << ":" << item.second << " ";
+    }
+    cout << endl;
+
+    // value which fails to copy leaves neither key nor value behind.
+    struct FailingValue
+    {
+        FailingValue() :fail(false)
+        {
+        }
+
+        FailingValue(const FailingValue& other) :fail(other.fail)
+        {
+            if (fail)
+                throw std::runtime_error("Error: copy of value failed.");
+        }
+
+        bool fail;
+    };
+    FlatMap<int, FailingValue> map2;
+    map2[1];
+    map2[3];
+    FailingValue failing;
+    failing.fail = true;
+    try
+    {
+        map2.Insert(2, failing);
+    }
+    catch (const std::runtime_error& e)
+    {
+        cout << e.what() << endl;
+    }
+    assert(map2.Size() == 2 && map2.Keys().Size() == map2.Values().Size() && !map2.Contains(2));
+
+    cout << "end of test FlatMap." << endl;
+}
+
+#endif
@@ -0,0 +1,245 @@
+//**************************************************************
+//         std::set alike container built on sorted Vector
+//**************************************************************
+
+#ifndef FLATSET_H
+#define FLATSET_H
+
+#include <algorithm>
+#include <functional>
+#include <iostream>
+#include <utility>
+#include "Vector.h"
+
+using namespace std;
+
+// node based set(red black tree) costs a pointer chase(usually a cache miss) per level of probe,
+// and 3 pointers + color per element. FlatSet keeps keys sorted in one Vector instead:
+// lookup is binary search on contiguous memory, no per element overhead.
+// the price is O(n) single insert/erase, so it is for read-mostly tables. for bulk loading,
+// Insert(first, last) sorts new keys and merges them with old keys once.
+
+// Returns the first position in [first, first+size) whose element is not less than key.
+// branchless: instead of jumping on comparison result, halve the range every iteration and
+// select the new base by conditional move, so there is no branch misprediction.
+// iteration count only depends on size.
+template<typename T, typename Compare>
+const T* BranchlessLowerBound(const T* first, size_t size, const T& key, Compare comp)
+{
+    if (size == 0)
+        return first;
+
+    while (size > 1)
+    {
+        size_t half = size / 2;
+        // answer is in [first, first+size], if first[half] < key, answer is beyond first+half.
+        first = comp(first[half], key) ? first + half : first;
+        size -= half;
+    }
+
+    return first + (comp(*first, key) ? 1 : 0);
+}
+
+template<typename K, typename Compare = std::less<K>>
+class FlatSet
+{
+public:
+    // keys must stay sorted, so they are not modifiable through iterator.
+    typedef const K* iterator;
+    typedef const K* const_iterator;
+
+    /*******************************************************/
+    // ctor and dtor
+    /*******************************************************/
+    FlatSet()
+    {
+    }
+
+    template<typename InputIt>
+    FlatSet(InputIt first, InputIt last)
+    {
+        Insert(first, last);
+    }
+
+    /*******************************************************/
+    // Capacity
+    /*******************************************************/
+    bool Empty() const
+    {
+        return keys.Empty();
+    }
+
+    size_t Size() const
+    {
+        return keys.Size();
+    }
+
+    void Reserve(size_t newCapacity)
+    {
+        keys.Reserve(newCapacity);
+    }
+
+    /*******************************************************/
+    // Lookup
+    /*******************************************************/
+
+    // Returns iterator to the first key not less than key.
+    iterator LowerBound(const K& key) const
+    {
+        return BranchlessLowerBound<K>(keys.Begin(), keys.Size(), key, comp);
+    }
+
+    // Returns iterator to key, or End() if there is no such key.
+    iterator Find(const K& key) const
+    {
+        iterator pos = LowerBound(key);
+        return (pos != End() && !comp(key, *pos)) ? pos : End();
+    }
+
+    bool Contains(const K& key) const
+    {
+        return Find(key) != End();
+    }
+
+    size_t Count(const K& key) const
+    {
+        return Contains(key) ? 1 : 0;
+    }
+
+    /*******************************************************/
+    // Modifiers
+    /*******************************************************/
+
+    void Clear()
+    {
+        keys.Clear();
+    }
+
+    // inserts key if it is not there yet, O(n) since keys after it are shifted.
+    // Returns iterator to the key and whether insertion took place.
+    std::pair<iterator, bool> Insert(const K& key)
+    {
+        iterator pos = LowerBound(key);
+        if (pos != End() && !comp(key, *pos))
+            return std::make_pair(pos, false);
+
+        iterator inserted = keys.Insert(keys.Begin() + (pos - Begin()), key);
+        return std::make_pair(inserted, true);
+    }
+
+    // inserts keys in range [first, last) which are not there yet.
+    // new keys are sorted and merged with old keys once, O(n + m log m) rather than O(n * m).
+    template<typename InputIt>
+    void Insert(InputIt first, InputIt last)
+    {
+        Vector<K> items;
+        for (; first != last; ++first)
+        {
+            items.Push_Back(*first);
+        }
+        if (items.Empty())
+            return;
+
+        Compare less = comp;
+        std::sort(items.Begin(), items.End(), less);
+        // keys are sorted, so !(a < b) means a is equal to b.
+        items.Erase(std::unique(items.Begin(), items.End(), [less](const K& a, const K& b) { return !less(a, b); }), items.End());
+
+        // merge two sorted sequences, key already in set wins.
+        Vector<K> merged;
+        merged.Reserve(keys.Size() + items.Size());
+        K* oldKey = keys.Begin();
+        K* newKey = items.Begin();
+        while (oldKey != keys.End() && newKey != items.End())
+        {
+            if (comp(*newKey, *oldKey))
+            {
+                merged.Push_Back(std::move(*newKey++));
+            }
+            else
+            {
+                if (!comp(*oldKey, *newKey))
+                    ++newKey; // equal key
+                merged.Push_Back(std::move(*oldKey++));
+            }
+        }
+        for (; oldKey != keys.End(); ++oldKey)
+            merged.Push_Back(std::move(*oldKey));
+        for (; newKey != items.End(); ++newKey)
+            merged.Push_Back(std::move(*newKey));
+
+        keys = std::move(merged);
+    }
+
+    // Returns number of erased keys(0 or 1).
+    size_t Erase(const K& key)
+    {
+        iterator pos = Find(key);
+        if (pos == End())
+            return 0;
+
+        Erase(pos);
+        return 1;
+    }
+
+    // Returns iterator following the erased key.
+    iterator Erase(iterator pos)
+    {
+        return keys.Erase(keys.Begin() + (pos - Begin()));
+    }
+
+    /*******************************************************/
+    // Iterators
+    /*******************************************************/
+
+    // specially for "Range for". Need begin(),end().
+    iterator begin() const
+    {
+        return Begin();
+    }
+
+    iterator end() const
+    {
+        return End();
+    }
+
+    iterator Begin() const
+    {
+        return keys.Begin();
+    }
+
+    iterator End() const
+    {
+        return keys.End();
+    }
+
+private:
+    Vector<K> keys; // sorted and unique
+    Compare comp;
+};
+
+// test routines for flat set
+void TestFlatSet()
+{
+    FlatSet<int> set1;
+    set1.Insert(5);
+    set1.Insert(1);
+    set1.Insert(3);
+    set1.Insert(3);
+    PrintVector(set1);
+
+    int values[] = { 9, 2, 3, 7, 2, 0 };
+    set1.Insert(values, values + 6);
+    PrintVector(set1);
+
+    cout << "find 7: " << (set1.Find(7) != set1.End()) << ", find 4: " << (set1.Find(4) != set1.End()) << endl;
+    cout << "lower bound of 4: " << *set1.LowerBound(4) << endl;
+
+    set1.Erase(3);
+    set1.Erase(set1.Begin());
+    PrintVector(set1);
+
+    cout << "end of test FlatSet." << endl;
+}
+
+#endif
@@ -0,0 +1,431 @@
+//**************************************************************
+//         intrusive doubly linked list, links live in elements
+//**************************************************************
+
+#ifndef INTRUSIVELIST_H
+#define INTRUSIVELIST_H
+
+#include <cassert>
+#include <cstddef>
+#include <iostream>
+#include <iterator>
+#include <string>
+#include <type_traits>
+#include "List.h"
+
+using namespace std;
+
+// List<T> copies each element into a Node<T> it allocates. objects which already live elsewhere
+// (timers of a connection, entries of a cache) can carry the links themselves instead:
+//
+//     struct Timer { long long deadline; IntrusiveListHook hook; };
+//     IntrusiveList<Timer, &Timer::hook> timers;
+//
+// the list only links and unlinks hooks, it never allocates, copies or destroys elements,
+// so elements must outlive their membership. an object can be in as many lists as it has hooks.
+// any element is unlinked in O(1) from a reference to it, and iterators are found from
+// references, which is what LRU chains need to move an entry to the front.
+// relinking is shared with List through ListTransfer.
+
+// links embedded in an element. hook of an element outside any list has null links.
+struct IntrusiveListHook : ListLinks
+{
+    IntrusiveListHook()
+    {
+        prev = nullptr;
+        next = nullptr;
+    }
+
+    // copy of an element is not in the lists of the original.
+    IntrusiveListHook(const IntrusiveListHook&)
+    {
+        prev = nullptr;
+        next = nullptr;
+    }
+
+    IntrusiveListHook& operator=(const IntrusiveListHook&)
+    {
+        return *this;
+    }
+
+    bool IsLinked() const
+    {
+        return next != nullptr;
+    }
+};
+
+template<typename T, IntrusiveListHook T::*Hook>
+class IntrusiveList
+{
+    typedef ListLinks* NodePtr;
+public:
+    typedef T value_type;
+    typedef T& reference;
+    typedef T* pointer;
+
+    class iterator
+    {
+    public:
+        typedef std::bidirectional_iterator_tag iterator_category;
+        typedef T value_type;
+        typedef ptrdiff_t difference_type;
+        typedef T* pointer;
+        typedef T& reference;
+
+        iterator() :nodePtr(nullptr)
+        {
+        }
+
+        iterator(NodePtr np) :nodePtr(np)
+        {
+        }
+
+        bool operator==(const iterator& other) const
+        {
+            return nodePtr == other.nodePtr;
+        }
+
+        bool operator!=(const iterator& other) const
+        {
+            return nodePtr != other.nodePtr;
+        }
+
+        reference operator*() const
+        {
+            return *ElementOf(nodePtr);
+        }
+
+        pointer operator->() const
+        {
+            return ElementOf(nodePtr);
+        }
+
+        // pre-increment
+        iterator& operator++()
+        {
+            nodePtr = nodePtr->next;
+            return *this;
+        }
+
+        // post-increment
+        iterator operator++(int)
+        {
+            iterator temp = *this;
+            nodePtr = nodePtr->next;
+            return temp;
+        }
+
+        // pre-decrement
+        iterator& operator--()
+        {
+            nodePtr = nodePtr->prev;
+            return *this;
+        }
+
+        // post-decrement
+        iterator operator--(int)
+        {
+            iterator temp = *this;
+            nodePtr = nodePtr->prev;
+            return temp;
+        }
+
+    public:
+        NodePtr nodePtr;// hook of element, or head of list for end
+    };
+
+    /*******************************************************/
+    // ctor and dtor
+    /*******************************************************/
+    IntrusiveList()
+    {
+        InitializeList();
+    }
+
+    // elements move to this list, other becomes empty.
+    IntrusiveList(IntrusiveList&& other)
+    {
+        InitializeList();
+        Splice(End(), other);
+    }
+
+    // elements are unlinked, not destroyed.
+    ~IntrusiveList()
+    {
+        Clear();
+    }
+
+    IntrusiveList& operator=(IntrusiveList&& other)
+    {
+        if (this != &other)
+        {
+            Clear();
+            Splice(End(), other);
+        }
+        return *this;
+    }
+
+    /*******************************************************/
+    // Capacity
+    /*******************************************************/
+    bool Empty() const
+    {
+        return size == 0;
+    }
+
+    size_t Size() const
+    {
+        return size;
+    }
+
+    /*******************************************************/
+    // Modifiers
+    /*******************************************************/
+
+    // unlinks all elements, their hooks become unlinked.
+    void Clear()
+    {
+        NodePtr current = head.next;
+        while (current != &head)
+        {
+            NodePtr next = current->next;
+            current->prev = nullptr;
+            current->next = nullptr;
+            current = next;
+        }
+        InitializeList();
+    }
+
+    // links value before pos. value must not be in a list through this hook.
+    // Returns iterator pointing to value.
+    iterator Insert(iterator pos, T& value)
+    {
+        NodePtr np = &(value.*Hook);
+        assert(!(value.*Hook).IsLinked());
+        np->next = pos.nodePtr;
+        np->prev = pos.nodePtr->prev;
+        pos.nodePtr->prev->next = np;
+        pos.nodePtr->prev = np;
+        ++size;
+        return np;
+    }
+
+    // unlinks the element at pos. Returns iterator following it.
+    iterator Erase(iterator pos)
+    {
+        NodePtr np = pos.nodePtr;
+        NodePtr next = np->next;
+        np->prev->next = next;
+        next->prev = np->prev;
+        np->prev = nullptr;
+        np->next = nullptr;
+        --size;
+        return next;
+    }
+
+    // unlinks value, which must be in this list, in O(1).
+    void Erase(T& value)
+    {
+        Erase(IteratorTo(value));
+    }
+
+    iterator Erase(iterator first, iterator last)
+    {
+        while (first != last)
+        {
+            first = Erase(first);
+        }
+        return last;
+    }
+
+    void Push_Back(T& value)
+    {
+        Insert(End(), value);
+    }
+
+    void Push_Front(T& value)
+    {
+        Insert(Begin(), value);
+    }
+
+    void Pop_Back()
+    {
+        Erase(--End());
+    }
+
+    void Pop_Front()
+    {
+        Erase(Begin());
+    }
+
+    /*******************************************************/
+    // Iterators
+    /*******************************************************/
+
+    // specially for "Range for". Need begin(),end().
+    iterator begin()
+    {
+        return Begin();
+    }
+
+    iterator end()
+    {
+        return End();
+    }
+
+    iterator Begin()
+    {
+        return head.next;
+    }
+
+    iterator End()
+    {
+        return &head;
+    }
+
+    // Returns iterator pointing to value, which must be in this list.
+    iterator IteratorTo(T& value)
+    {
+        assert((value.*Hook).IsLinked());
+        return &(value.*Hook);
+    }
+
+    /*******************************************************/
+    // Accessor
+    /*******************************************************/
+
+    // Calling front on an empty container is undefined.
+    reference Front()
+    {
+        return *Begin();
+    }
+
+    // Calling back on an empty container is undefined.
+    reference Back()
+    {
+        return *(--End());
+    }
+
+    /*******************************************************/
+    // Operations
+    /*******************************************************/
+
+    // transfer all elements from another list into *this before pos.
+    void Splice(iterator pos, IntrusiveList& other)
+    {
+        if (!other.Empty() && this != &other)
+        {
+            ListTransfer(pos.nodePtr, other.head.next, &other.head);
+            size += other.size;
+            other.size = 0;
+        }
+    }
+
+    // transfers the element pointed to by it from other into *this before pos.
+    // with other being *this, it moves an element within the list, e.g. to the front of an LRU chain.
+    void Splice(iterator pos, IntrusiveList& other, iterator it)
+    {
+        iterator last = it;
+        ++last;
+        if (pos != it && pos != last)
+        {
+            ListTransfer(pos.nodePtr, it.nodePtr, last.nodePtr);
+            --other.size;
+            ++size;
+        }
+    }
+
+    // transfers the elements in the range [first, last) from other into *this before pos.
+    void Splice(iterator pos, IntrusiveList& other, iterator first, iterator last)
+    {
+        if (this != &other)
+        {
+            size_t count = 0;
+            for (iterator it = first; it != last; ++it)
+            {
+                ++count;
+            }
+            other.size -= count;
+            size += count;
+        }
+        ListTransfer(pos.nodePtr, first.nodePtr, last.nodePtr);
+    }
+
+private:
+    IntrusiveList(const IntrusiveList&);
+    IntrusiveList& operator=(const IntrusiveList&);
+
+    void InitializeList()
+    {
+        head.next = &head;
+        head.prev = &head;
+        size = 0;
+    }
+
+    // element holding hook np, the offset of the hook is taken from a storage of T.
+    static T* ElementOf(NodePtr np)
+    {
+        typename std::aligned_storage<sizeof(T), std::alignment_of<T>::value>::type storage;
+        T* sample = reinterpret_cast<T*>(&storage);
+        ptrdiff_t offset = reinterpret_cast<char*>(&(sample->*Hook)) - reinterpret_cast<char*>(sample);
+        return reinterpret_cast<T*>(reinterpret_cast<char*>(static_cast<IntrusiveListHook*>(np)) - offset);
+    }
+
+private:
+    ListLinks head;// head of list, its links are not part of any element
+    size_t size;
+};
+
+struct IntrusiveTimer
+{
+    long long deadline;
+    string name;
+    IntrusiveListHook timerHook; // in one list of timers
+    IntrusiveListHook lruHook;   // in recently used chain
+};
+
+// test routines for intrusive list
+void TestIntrusiveList()
+{
+    IntrusiveTimer timers[5];
+    IntrusiveList<IntrusiveTimer, &IntrusiveTimer::timerHook> pending;
+    IntrusiveList<IntrusiveTimer, &IntrusiveTimer::lruHook> recent;
+    for (int i = 0; i < 5; i++)
+    {
+        timers[i].deadline = 100 * i;
+        timers[i].name = "timer" + to_string(i);
+        pending.Push_Back(timers[i]);
+        recent.Push_Front(timers[i]);
+    }
+    assert(pending.Size() == 5 && &pending.Front() == &timers[0] && &recent.Front() == &timers[4]);
+
+    // cancel from anywhere in O(1), the other list is not affected.
+    pending.Erase(timers[2]);
+    assert(!timers[2].timerHook.IsLinked() && timers[2].lruHook.IsLinked());
+    for (auto& timer : pending)
+    {
+        cout << timer.name << " ";
+    }
+    cout << endl;
+
+    // touch moves an entry to the front of LRU chain.
+    recent.Splice(recent.Begin(), recent, recent.IteratorTo(timers[1]));
+    assert(&recent.Front() == &timers[1] && &recent.Back() == &timers[0] && recent.Size() == 5);
+
+    // expired timers move to another list.
+    IntrusiveList<IntrusiveTimer, &IntrusiveTimer::timerHook> expired;
+    expired.Splice(expired.End(), pending, pending.Begin(), pending.IteratorTo(timers[3]));
+    assert(expired.Size() == 2 && pending.Size() == 2 && &expired.Back() == &timers[1]);
+
+    pending.Pop_Front();
+    assert(!timers[3].timerHook.IsLinked() && &pending.Front() == &timers[4]);
+
+    IntrusiveList<IntrusiveTimer, &IntrusiveTimer::timerHook> moved(std::move(expired));
+    assert(expired.Empty() && moved.Size() == 2 && &moved.Front() == &timers[0]);
+    moved.Clear();
+    assert(!timers[0].timerHook.IsLinked() && !timers[1].timerHook.IsLinked());
+
+    cout << "end of test IntrusiveList." << endl;
+}
+
+#endif
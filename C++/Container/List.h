@@ -5,17 +5,63 @@
 #ifndef LIST_H
 #define LIST_H
 
+#include <algorithm>
+#include <cassert>
+#include <cstdlib>
+#include <functional>
 #include <iostream>
+#include <iterator>
 #include <list>
+#include <new>
+#include <string>
+#include <vector>
+#include <type_traits>
+#include <utility>
 #include "..\Memory\Allocator.h"
+#include "..\Memory\PoolAllocator.h"
 
 using namespace std;
 
+// links of a list node. sentinel of list is only links without value, kept inside List itself,
+// so an empty list allocates nothing.
+struct ListLinks
+{
+    ListLinks* prev;
+    ListLinks* next;
+};
+
+// move nodes [first, last) before pos, within one list or from another list sharing the links.
+inline void ListTransfer(ListLinks* pos, ListLinks* first, ListLinks* last)
+{
+    if (first != last)
+    {
+        // unlink [first, last) from old list
+        ListLinks* firstNode = first;
+        ListLinks* endNode = last->prev;
+
+        ListLinks* sourcePrevNode = firstNode->prev;
+        ListLinks* SourceNextNode = last;
+
+        // unlink: reset old list
+        sourcePrevNode->next = SourceNextNode;
+        SourceNextNode->prev = sourcePrevNode;
+
+        // unlink reset to-be-moved node in old list and link to new list
+        ListLinks* destPosNode = pos;
+        ListLinks* destPrevNode = destPosNode->prev;
+
+        firstNode->prev = destPrevNode;
+        endNode->next = destPosNode;
+
+        // relink for new list
+        destPrevNode->next = firstNode;
+        destPosNode->prev = endNode;
+    }
+}
+
 template<typename T>
-struct Node
+struct Node : ListLinks
 {
-    Node* prev;
-    Node* next;
     T value;
 };
 
@@ -24,10 +70,14 @@ struct Node
 template<typename T>
 class list_iterator
 {
-    typedef Node<T>* NodePtr;
+    typedef ListLinks* NodePtr;
+public:
+    typedef std::bidirectional_iterator_tag iterator_category;
+    typedef T value_type;
+    typedef ptrdiff_t difference_type;
     typedef T& reference; // raw data reference
     typedef T* pointer; // raw data pointer
-public:
+
     list_iterator()
     {
     }
@@ -53,12 +103,12 @@ public:
 
     reference operator*() const
     {
-        return nodePtr->value;
+        return static_cast<Node<T>*>(nodePtr)->value;
     }
 
     pointer operator->() const
     {
-        return &(nodePtr->value);
+        return &static_cast<Node<T>*>(nodePtr)->value;
     }
 
     // pre-increment
@@ -94,10 +144,14 @@ public:
     NodePtr nodePtr;// it is iterator for node pointer, make it public for List<T>
 };
 
-template<typename T>
-class List
+// nodes are allocated one by one from Alloc rebound to Node<T>.
+// with PoolAllocator nodes come from chunks owned by the list, erased nodes are reused and
+// Clear() frees all chunks at once. nodes of such list can only be spliced within the list itself.
+template<typename T, typename Alloc = Allocator<T>>
+class List : private Alloc::template rebind<Node<T>>::other
 {
-    typedef Node<T>* NodePtr;
+    typedef typename Alloc::template rebind<Node<T>>::other NodeAlloc;
+    typedef ListLinks* NodePtr;
     typedef list_iterator<T> iterator;
     typedef const list_iterator<T> const_iterator;
     typedef T& reference; // raw data reference
@@ -130,16 +184,18 @@ public:
     }
 
     List(const List& other)
+        :NodeAlloc(other.GetAlloc())
     {
         InitializeList();
         InsertRange(Begin(), other.Begin(), other.End());
     }
 
+    // nodes stay in place with the allocator that owns them.
     List(List&& other)
+        :NodeAlloc(std::move(other.GetAlloc()))
     {
         InitializeList();
-        std::swap(head, other.head);
-        std::swap(size, other.size);
+        TakeNodes(other);
     }
 
     List(std::initializer_list<T> init)
@@ -167,8 +223,8 @@ public:
         if (this != &other)
         {
             Clear();
-            std::swap(head, other.head);
-            std::swap(size, other.size);
+            GetAlloc() = std::move(other.GetAlloc());
+            TakeNodes(other);
         }
 
         return *this;
@@ -193,38 +249,55 @@ public:
     /*******************************************************/
 
     // Assigns values to the container.
+    // values of existing nodes are overwritten, only the size difference is inserted or erased.
     void Assign(size_t count, const T& value)
     {
-        Clear();
-        InsertNodes(Begin(), count, value);
+        iterator current = Begin();
+        for (; current != End() && count > 0; ++current, --count)
+        {
+            *current = value;
+        }
+
+        if (count > 0)
+        {
+            InsertNodes(End(), count, value);
+        }
+        else
+        {
+            Erase(current, End());
+        }
     }
 
     // Replaces the contents with copies of those in the range[first, last).
+    // as std, old storage is reused: values of existing nodes are overwritten, then missing
+    // nodes are inserted or extra nodes are erased. erased nodes go back to the allocator,
+    // with PoolAllocator to its free list for the next insert.
     void Assign(iterator first, iterator last)
     {
-        // NOTE: note std assign range will implement by reusing old storage
-        // and erase extra nodes to improve performance. Here do it for simplicity
-        // by clear old storage directly and insert new ones.
-        Clear();
-        InsertRange(Begin(), first, last);
+        iterator current = Begin();
+        for (; current != End() && first != last; ++current, ++first)
+        {
+            *current = *first;
+        }
+
+        if (first != last)
+        {
+            InsertRange(End(), first, last);
+        }
+        else
+        {
+            Erase(current, End());
+        }
     }
 
     // Removes all elements from the container.
     void Clear()
     {
-        // delete from begin() node
-        NodePtr currentNode = head->next;
-        while (currentNode != head)
-        {
-            // cache next node of current, we will delete current now so we cannot get its next after deletion.
-            NodePtr nextNode = currentNode->next;
-            DestroyNode(currentNode);
-            currentNode = nextNode;
-        }
+        DestroyNodes(std::integral_constant<bool, HasReleaseAll<NodeAlloc>::value>());
 
         // reset head
-        head->next = head;
-        head->prev = head;
+        head.next = &head;
+        head.prev = &head;
         size = 0;
     }
 
@@ -236,6 +309,12 @@ public:
         return --pos;
     }
 
+    // inserts value before pos by moving it.
+    iterator Insert(iterator pos, T&& value)
+    {
+        return Emplace(pos, std::move(value));
+    }
+
     // return iterator pointing to the first element inserted, or pos if count==0.
     iterator Insert(iterator pos, size_t count, const T& value)
     {
@@ -300,6 +379,11 @@ public:
         Insert(End(), value);
     }
 
+    void Push_Back(T&& value)
+    {
+        Emplace_Back(std::move(value));
+    }
+
     void Pop_Back()
     {
         Erase(--End());
@@ -310,30 +394,38 @@ public:
         Insert(Begin(), value);
     }
 
+    void Push_Front(T&& value)
+    {
+        Emplace_Front(std::move(value));
+    }
+
     void Pop_Front()
     {
         Erase(Begin());
     }
 
     // constructs element in-place.
+    // Returns iterator pointing to the emplaced element.
     template<class... Args>
     iterator Emplace(iterator pos, Args&&... args)
     {
-        // TODO
+        return InsertNode(pos, std::forward<Args>(args)...);
     }
 
     // constructs an element in-place at the beginning.
+    // Returns a reference to the inserted element.
     template<class... Args>
-    void Emplace_Front(Args&&... args)
+    reference Emplace_Front(Args&&... args)
     {
-        // TODO
+        return *Emplace(Begin(), std::forward<Args>(args)...);
     }
 
     // constructs an element in-place at the end.
+    // Returns a reference to the inserted element.
     template<class... Args>
-    void Emplace_Back(Args&&... args)
+    reference Emplace_Back(Args&&... args)
     {
-        // TODO
+        return *Emplace(End(), std::forward<Args>(args)...);
     }
 
     /*******************************************************/
@@ -353,12 +445,12 @@ public:
 
     iterator Begin()
     {
-        return head->next;
+        return head.next;
     }
 
     iterator Begin() const
     {
-        return head->next;
+        return head.next;
     }
 
     const_iterator CBegin()
@@ -373,12 +465,12 @@ public:
 
     iterator End()
     {
-        return head;
+        return &head;
     }
 
     iterator End() const
     {
-        return head;
+        return const_cast<NodePtr>(&head);
     }
 
     const_iterator CEnd()
@@ -416,8 +508,20 @@ public:
 
     // merges two sorted lists. The lists should be sorted into ascending order.
     // No elements are copied. The container other becomes empty after the operation.
+    // nodes are relinked if allocators compare equal, otherwise see Splice.
     void Merge(List& other)
     {
+        Merge(other, std::less<T>());
+    }
+
+    // merges two lists sorted by comp. equal elements of this list stay before those of other.
+    template<typename Compare>
+    void Merge(List& other, Compare comp)
+    {
+        if (this == &other)
+            return;
+
+        bool relink = GetAlloc() == other.GetAlloc();
         iterator first1 = Begin();
         iterator last1 = End();
         iterator first2 = other.Begin();
@@ -425,10 +529,18 @@ public:
 
         while (first1 != last1 && first2 != last2)
         {
-            if (*first1 > *first2)
+            if (comp(*first2, *first1))
             {
                 iterator next = first2;
-                Transfer(first1, first2, ++next);// transfer first2 to list1, [first1, first1+1)
+                ++next;
+                if (relink)
+                {
+                    Transfer(first1, first2, next);// transfer first2 to list1, [first1, first1+1)
+                }
+                else
+                {
+                    MoveElements(first1, other, first2, next);
+                }
                 first2 = next;
             }
             else
@@ -438,36 +550,81 @@ public:
         }
 
         // after loop the whole list1, if still left with list2, transfer left nodes to append to list1
+        if (!relink)
+        {
+            MoveElements(first1, other, first2, last2);
+            return;
+        }
         if (first2 != last2)
         {
             Transfer(first1, first2, last2);
         }
+
+        IncreaseSize(other.size);
+        other.size = 0;
     }
 
     // transfer all elements from another list into *this.
     // The elements are inserted before the element pointed to by pos.
     // The container other becomes empty after the operation.
+    // nodes are relinked in O(1) if allocators compare equal. otherwise, e.g. lists with their own
+    // PoolAllocator, elements are moved into nodes of this list in O(n), iterators to them are invalidated.
     void Splice(iterator pos, List& other)
     {
-        if (!other.Empty())
+        if (other.Empty() || this == &other)
+            return;
+
+        if (GetAlloc() != other.GetAlloc())
+        {
+            MoveElements(pos, other, other.Begin(), other.End());
+        }
+        else
         {
             Transfer(pos, other.Begin(), other.End());
+            IncreaseSize(other.size);
+            other.size = 0;
         }
     }
 
     // Transfers the element pointed to by it from other into *this.
     // The element is inserted before the element pointed to by pos.
+    // the node is relinked if allocators compare equal, otherwise the element is moved as above.
     void Splice(iterator pos, List& other, iterator it)
     {
         iterator last = it;
         ++last;
-        Transfer(pos, it, last);
+        if (this != &other && GetAlloc() != other.GetAlloc())
+        {
+            MoveElements(pos, other, it, last);
+        }
+        else if (pos != it && pos != last)
+        {
+            Transfer(pos, it, last);
+            other.DecreaseSize(1);
+            IncreaseSize(1);
+        }
     }
 
     // Transfers the elements in the range [first, last) from other into *this.
     // The elements are inserted before the element pointed to by pos.
+    // nodes are relinked if allocators compare equal, otherwise the elements are moved as above.
     void Splice(iterator pos, List& other, iterator first, iterator last)
     {
+        if (this != &other && GetAlloc() != other.GetAlloc())
+        {
+            MoveElements(pos, other, first, last);
+            return;
+        }
+        if (this != &other)
+        {
+            size_t count = 0;
+            for (iterator it = first; it != last; ++it)
+            {
+                ++count;
+            }
+            other.DecreaseSize(count);
+            IncreaseSize(count);
+        }
         Transfer(pos, first, last);
     }
 
@@ -538,7 +695,49 @@ public:
     // Sorts the elements in ascending order.
     void Sort()
     {
-        // TODO: quick sort
+        Sort(std::less<T>());
+    }
+
+    // Sorts the elements by comp, the order of equal elements is preserved.
+    // bottom-up merge sort: elements are taken one by one as runs of 1, and the two newest runs
+    // are merged while they have the same length, like carries of a binary counter. runs stay
+    // adjacent in this list and are merged in place by relinking nodes, nothing is allocated
+    // and no iterator is invalidated. O(n log n) comparisons, recent runs are merged while hot in cache.
+    template<typename Compare>
+    void Sort(Compare comp)
+    {
+        if (size < 2)
+            return;
+
+        // first node and length of each pending run, lengths strictly decrease from bottom,
+        // so 64 runs cover any size.
+        iterator runFirst[64];
+        size_t runCount[64];
+        size_t top = 0;
+
+        iterator current = Begin();
+        while (current != End())
+        {
+            runFirst[top] = current;
+            runCount[top] = 1;
+            ++top;
+            ++current;
+
+            while (top >= 2 && runCount[top - 2] == runCount[top - 1])
+            {
+                runFirst[top - 2] = MergeAdjacent(runFirst[top - 2], runFirst[top - 1], current, comp);
+                runCount[top - 2] += runCount[top - 1];
+                --top;
+            }
+        }
+
+        // merge the rest, newest runs first.
+        while (top >= 2)
+        {
+            runFirst[top - 2] = MergeAdjacent(runFirst[top - 2], runFirst[top - 1], End(), comp);
+            runCount[top - 2] += runCount[top - 1];
+            --top;
+        }
     }
 
 private:
@@ -547,54 +746,110 @@ private:
     // Allocator for one node of list
     /*******************************************************/
 
+    NodeAlloc& GetAlloc()
+    {
+        return *this;
+    }
+
+    const NodeAlloc& GetAlloc() const
+    {
+        return *this;
+    }
+
     // allocate one node
-    // given list<int>, we have allocator<T>, but we actually need to
-    // allocate memory Node<int>, not int.
-    NodePtr AllocNode()
+    // given List<int>, we have Alloc<int>, but we actually need to
+    // allocate memory Node<int>, not int. NodeAlloc is Alloc rebound to Node<T>.
+    Node<T>* AllocNode()
     {
-        // conversion of allocator from T to Node<T>
-        typename allocator<T>::rebind<Node<T>>::other allocProxy;
-        return allocProxy.allocate(1);
+        return GetAlloc().allocate(1);
     }
 
-    void DeallocNode(NodePtr np)
+    void DeallocNode(Node<T>* np)
     {
-        typename allocator<T>::rebind<Node<T>>::other allocProxy;
-        allocProxy.deallocate(np, 1);
+        GetAlloc().deallocate(np, 1);
     }
 
-    NodePtr CreateNode(const T& t)
+    // construct value of node in-place by forwarding args to ctor of T.
+    template<class... Args>
+    Node<T>* CreateNode(Args&&... args)
     {
-        NodePtr np = AllocNode();
-        // use allocator<T> to construct.
-        alloc.construct(&np->value, t);
+        Node<T>* np = AllocNode();
+        // NodeAlloc constructs Node<T>, value is constructed by placement new.
+        try
+        {
+            ::new((void*)&np->value) T(std::forward<Args>(args)...);
+        }
+        catch (...)
+        {
+            DeallocNode(np);
+            throw;
+        }
         return np;
     }
 
     void DestroyNode(NodePtr np)
     {
-        alloc.destroy(&np->value);
-        DeallocNode(np);
+        Node<T>* node = static_cast<Node<T>*>(np);
+        node->value.~T();
+        DeallocNode(node);
+    }
+
+    // destroy all nodes, free them one by one.
+    void DestroyNodes(std::false_type)
+    {
+        // delete from begin() node
+        NodePtr currentNode = head.next;
+        while (currentNode != &head)
+        {
+            // cache next node of current, we will delete current now so we cannot get its next after deletion.
+            NodePtr nextNode = currentNode->next;
+            DestroyNode(currentNode);
+            currentNode = nextNode;
+        }
+    }
+
+    // destroy all values, then allocator frees all nodes at once.
+    void DestroyNodes(std::true_type)
+    {
+        for (NodePtr currentNode = head.next; currentNode != &head; currentNode = currentNode->next)
+        {
+            static_cast<Node<T>*>(currentNode)->value.~T();
+        }
+        GetAlloc().release_all();
     }
 
     /*******************************************************/
     // Utility functions to handle node
     /*******************************************************/
 
-    // initialize list by allocate a node, make its next/prev points to itself.
+    // initialize list by making next/prev of head point to itself.
     void InitializeList()
     {
-        head = AllocNode();
-        head->next = head;
-        head->prev = head;
+        head.next = &head;
+        head.prev = &head;
         size = 0;
     }
 
-    // insert one node into list at position
-    void InsertNode(iterator pos, const T& value)
+    // take all nodes of other, which must be allocated by allocator of this list. this list is empty.
+    void TakeNodes(List& other)
+    {
+        if (!other.Empty())
+        {
+            head.next = other.head.next;
+            head.prev = other.head.prev;
+            head.next->prev = &head;
+            head.prev->next = &head;
+            size = other.size;
+            other.InitializeList();
+        }
+    }
+
+    // insert one node constructed from args into list at position, return the new node.
+    template<class... Args>
+    NodePtr InsertNode(iterator pos, Args&&... args)
     {
         // create new list node and specify its prev/next.
-        NodePtr tmp = CreateNode(value);
+        NodePtr tmp = CreateNode(std::forward<Args>(args)...);
         tmp->next = pos.nodePtr;
         tmp->prev = pos.nodePtr->prev;
         // reset original pos and pos-1
@@ -606,6 +861,7 @@ private:
 
         // update size
         IncreaseSize(1);
+        return tmp;
     }
 
     // insert n nodes into list at position
@@ -635,38 +891,54 @@ private:
         size -= count;
     }
 
-    // move elements from [first, last) at pos.
-    void Transfer(iterator pos, iterator first, iterator last)
+    // merges sorted adjacent ranges [first1, first2) and [first2, last) of this list in place.
+    // elements of the second range are moved before greater elements of the first range,
+    // equal elements keep their order. Returns the first element of the merged range.
+    template<typename Compare>
+    iterator MergeAdjacent(iterator first1, iterator first2, iterator last, Compare comp)
     {
-        if (first != last)
+        iterator mergedFirst = comp(*first2, *first1) ? first2 : first1;
+        while (first1 != first2 && first2 != last)
         {
-            // unlink [first, last) from old list
-            NodePtr firstNode = first.nodePtr;
-            NodePtr endNode = last.nodePtr->prev;
-
-            NodePtr sourcePrevNode = firstNode->prev;
-            NodePtr SourceNextNode = last.nodePtr;
-
-            // unlink: reset old list
-            sourcePrevNode->next = SourceNextNode;
-            SourceNextNode->prev = sourcePrevNode;
-
-            // unlink reset to-be-moved node in old list and link to new list
-            NodePtr destPosNode = pos.nodePtr;
-            NodePtr destPrevNode = destPosNode->prev;
-
-            firstNode->prev = destPrevNode;
-            endNode->next = destPosNode;
+            if (comp(*first2, *first1))
+            {
+                // move the whole run of second range elements less than *first1 at once.
+                iterator next = first2;
+                ++next;
+                while (next != last && comp(*next, *first1))
+                {
+                    ++next;
+                }
+                Transfer(first1, first2, next);
+                first2 = next;
+            }
+            else
+            {
+                ++first1;
+            }
+        }
+        return mergedFirst;
+    }
 
-            // relink for new list
-            destPrevNode->next = firstNode;
-            destPosNode->prev = endNode;
+    // move elements from [first, last) at pos.
+    // moves elements [first, last) of other into new nodes before pos and erases them from other,
+    // for lists whose nodes can not be relinked since another allocator owns them.
+    void MoveElements(iterator pos, List& other, iterator first, iterator last)
+    {
+        while (first != last)
+        {
+            Emplace(pos, std::move(*first));
+            first = other.Erase(first);
         }
     }
 
+    void Transfer(iterator pos, iterator first, iterator last)
+    {
+        ListTransfer(pos.nodePtr, first.nodePtr, last.nodePtr);
+    }
+
 private:
-    std::allocator<T> alloc;
-    NodePtr head;// head node of list, make list meets the stl [) range.
+    ListLinks head;// head node of list, make list meets the stl [) range.
     size_t size;// number of elements.
 };
 
@@ -789,10 +1061,154 @@ void TestMyList()
     cout << "end of test List." << endl;
 }
 
+// list with node pool: erased nodes are reused, Clear frees chunks.
+void TestPoolList()
+{
+    List<string, PoolAllocator<string>> orders;
+    for (int i = 0; i < 100; i++)
+    {
+        orders.Push_Back(to_string(i));
+    }
+    string* last = &orders.Back();
+    orders.Pop_Back();
+    orders.Push_Front("new");
+    assert(&orders.Front() == last && orders.Size() == 100);
+
+    // erase and insert in the middle, order is kept.
+    auto it = orders.Begin();
+    ++it;
+    it = orders.Erase(it);
+    orders.Insert(it, "mid");
+    assert(*++orders.Begin() == "mid" && orders.Back() == "98");
+
+    // moved list keeps its nodes and the pool owning them.
+    List<string, PoolAllocator<string>> moved(std::move(orders));
+    assert(orders.Empty() && moved.Size() == 100 && moved.Front() == "new");
+    orders.Push_Back("again");
+    moved = std::move(orders);
+    assert(moved.Size() == 1 && moved.Front() == "again");
+
+    List<string, PoolAllocator<string>> copy(moved);
+    moved.Clear();
+    assert(moved.Empty() && copy.Front() == "again");
+    PrintList(copy);
+
+    // lists with their own pools move elements on Splice and Merge, nodes stay with their pool.
+    List<string, PoolAllocator<string>> left;
+    List<string, PoolAllocator<string>> right;
+    for (int i = 0; i < 6; i++)
+    {
+        (i % 2 == 0 ? left : right).Push_Back(to_string(i));
+    }
+    left.Merge(right);
+    assert(right.Empty() && left.Size() == 6 && left.Front() == "0" && left.Back() == "5");
+    right.Push_Back("a");
+    right.Push_Back("b");
+    right.Push_Back("c");
+    left.Splice(left.Begin(), right, ++right.Begin());
+    left.Splice(left.End(), right);
+    assert(right.Empty() && left.Size() == 9 && left.Front() == "b" && left.Back() == "c");
+    right.Splice(right.End(), left, left.Begin(), ++++left.Begin());
+    assert(right.Size() == 2 && right.Back() == "0" && left.Size() == 7);
+    // freeing the pool of right leaves left intact.
+    right.Clear();
+    PrintList(left);
+
+    cout << "end of test pool List." << endl;
+}
+
+// sort relinks nodes, equal keys keep their order.
+void TestListSort()
+{
+    List<pair<int, int>> records;
+    vector<pair<int, int>> expected;
+    for (int i = 0; i < 1000; i++)
+    {
+        pair<int, int> record(std::rand() % 37, i);
+        records.Push_Back(record);
+        expected.push_back(record);
+    }
+    pair<int, int>* firstAddress = &records.Front();
+    auto byKey = [](const pair<int, int>& a, const pair<int, int>& b) { return a.first < b.first; };
+    records.Sort(byKey);
+    std::stable_sort(expected.begin(), expected.end(), byKey);
+    assert(records.Size() == 1000 && std::equal(expected.begin(), expected.end(), records.Begin()));
+
+    // nodes are moved, not copied.
+    bool found = false;
+    for (auto& record : records)
+    {
+        found = found || &record == firstAddress;
+    }
+    assert(found);
+
+    List<int> lst1;
+    List<int> lst2;
+    int values1[] = { 5, 1, 9, 3 };
+    int values2[] = { 8, 2, 6 };
+    for (int v : values1)
+    {
+        lst1.Push_Back(v);
+    }
+    for (int v : values2)
+    {
+        lst2.Push_Back(v);
+    }
+    lst1.Sort(std::greater<int>());
+    lst2.Sort(std::greater<int>());
+    lst1.Merge(lst2, std::greater<int>());
+    PrintList(lst1);
+    assert(lst1.Size() == 7 && lst2.Empty() && lst1.Front() == 9 && lst1.Back() == 1);
+
+    lst1.Sort();
+    PrintList(lst1);
+    assert(lst1.Front() == 1 && lst1.Back() == 9);
+
+    cout << "end of test List Sort." << endl;
+}
+
+// assign overwrites values in place, nodes are kept.
+void TestListAssign()
+{
+    List<string> state(5, "old");
+    string* second = &*++state.Begin();
+
+    List<string> snapshot;
+    for (int i = 0; i < 3; i++)
+    {
+        snapshot.Push_Back(to_string(i));
+    }
+    state = snapshot;
+    PrintList(state);
+    assert(state.Size() == 3 && &*++state.Begin() == second && state.Back() == "2");
+
+    snapshot.Push_Back("3");
+    snapshot.Push_Back("4");
+    snapshot.Push_Back("5");
+    state = snapshot;
+    assert(state.Size() == 6 && &*++state.Begin() == second && state.Back() == "5");
+
+    state.Assign(2, "x");
+    PrintList(state);
+    assert(state.Size() == 2 && &state.Back() == second);
+
+    // erased nodes are reused by the pool, the last one erased first.
+    List<int, PoolAllocator<int>> ticks(100, 1);
+    int* last = &ticks.Back();
+    ticks.Assign(10, 2);
+    ticks.Assign(11, 3);
+    assert(ticks.Size() == 11 && &ticks.Back() == last && ticks.Front() == 3);
+
+    cout << "end of test List Assign." << endl;
+}
+
 void TestList()
 {
     TestSTDList();
     TestMyList();
+    TestPoolList();
+    TestListSort();
+    TestListAssign();
 }
 
 #endif
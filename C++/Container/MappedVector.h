@@ -0,0 +1,421 @@
+//**************************************************************
+//         read-only vector view of a memory-mapped snapshot file
+//**************************************************************
+
+#ifndef MAPPEDVECTOR_H
+#define MAPPEDVECTOR_H
+
+#include <cassert>
+#include <cstdio>
+#include <iostream>
+#include <stdexcept>
+#include <type_traits>
+#include "Vector.h"
+#include "BinaryFormat.h"
+
+#if defined(_WIN32)
+#ifndef NOMINMAX
+#define NOMINMAX
+#endif
+#include <windows.h>
+#include <fcntl.h>
+#include <sys/stat.h>
+#else
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#endif
+
+using namespace std;
+
+// loading a snapshot by Vector::ReadFrom still copies every byte from page cache into the vector.
+// MappedVector maps the file written by Vector::WriteTo into address space and uses the elements
+// in place: opening costs one mmap call whatever the file size is, pages are loaded by the OS when
+// they are touched first, and several processes mapping the same file share the physical pages.
+// elements are read-only(file is mapped with PROT_READ), accessors mirror const accessors of Vector.
+// checksum is not verified on open since it would read the whole file, call Verify() to do so.
+template<typename T>
+class MappedVector
+{
+    static_assert(std::is_trivially_copyable<T>::value, "only trivially copyable elements can be mapped.");
+public:
+    typedef const T* iterator;
+    typedef const T* const_iterator;
+    typedef const T& reference;
+    typedef const T& const_reference;
+
+    /*******************************************************/
+    // ctor and dtor
+    /*******************************************************/
+    MappedVector() :_mapping(nullptr), _mappedSize(0), _first(nullptr), _count(0), _checksum(0)
+    {
+    }
+
+    // maps file at path. If file can not be opened or is not a valid vector file of T,
+    // an exception of type std::runtime_error is thrown.
+    explicit MappedVector(const char* path) :_mapping(nullptr), _mappedSize(0), _first(nullptr), _count(0), _checksum(0)
+    {
+        Open(path);
+    }
+
+    MappedVector(const MappedVector&) = delete;
+    MappedVector& operator=(const MappedVector&) = delete;
+
+    MappedVector(MappedVector&& other) :_mapping(nullptr), _mappedSize(0), _first(nullptr), _count(0), _checksum(0)
+    {
+        Swap(other);
+    }
+
+    MappedVector& operator=(MappedVector&& other)
+    {
+        if (this != &other)
+        {
+            Close();
+            Swap(other);
+        }
+        return *this;
+    }
+
+    ~MappedVector()
+    {
+        Close();
+    }
+
+    void Open(const char* path)
+    {
+        Close();
+
+        size_t fileSize = 0;
+        void* mapping = MapFile(path, fileSize);
+        if (fileSize < sizeof(VectorFileHeader))
+        {
+            UnmapFile(mapping, fileSize);
+            throw std::runtime_error("Error: vector file is truncated.");
+        }
+
+        const VectorFileHeader& header = *(const VectorFileHeader*)mapping;
+        try
+        {
+            CheckVectorFileHeader(header, sizeof(T), std::alignment_of<T>::value);
+            if (header.dataOffset + header.count * sizeof(T) > fileSize)
+                throw std::runtime_error("Error: vector file is truncated.");
+        }
+        catch (...)
+        {
+            UnmapFile(mapping, fileSize);
+            throw;
+        }
+
+        _mapping = mapping;
+        _mappedSize = fileSize;
+        _first = (const T*)((const char*)mapping + header.dataOffset);
+        _count = size_t(header.count);
+        _checksum = header.checksum;
+    }
+
+    // unmaps file, view becomes empty.
+    void Close()
+    {
+        if (_mapping != nullptr)
+        {
+            UnmapFile(_mapping, _mappedSize);
+        }
+        _mapping = nullptr;
+        _mappedSize = 0;
+        _first = nullptr;
+        _count = 0;
+        _checksum = 0;
+    }
+
+    // reads all elements and compares their checksum with the one in header.
+    bool Verify() const
+    {
+        return ChecksumBytes(_first, _count * sizeof(T)) == _checksum;
+    }
+
+    void Swap(MappedVector& other)
+    {
+        std::swap(_mapping, other._mapping);
+        std::swap(_mappedSize, other._mappedSize);
+        std::swap(_first, other._first);
+        std::swap(_count, other._count);
+        std::swap(_checksum, other._checksum);
+    }
+
+    /*******************************************************/
+    // Capacity
+    /*******************************************************/
+    bool Empty() const
+    {
+        return _count == 0;
+    }
+
+    size_t Size() const
+    {
+        return _count;
+    }
+
+    /*******************************************************/
+    // Iterators
+    /*******************************************************/
+
+    // specially for "Range for". Need begin(),end().
+    iterator begin() const
+    {
+        return Begin();
+    }
+
+    iterator end() const
+    {
+        return End();
+    }
+
+    iterator Begin() const
+    {
+        return _first;
+    }
+
+    iterator End() const
+    {
+        return _first + _count;
+    }
+
+    const_iterator CBegin() const
+    {
+        return Begin();
+    }
+
+    const_iterator CEnd() const
+    {
+        return End();
+    }
+
+    /*******************************************************/
+    // Accessor
+    /*******************************************************/
+
+    // Returns a reference to the element at specified location pos, with bounds checking.
+    // If pos is not within the range of the container, an exception of type std::out_of_range is thrown.
+    reference At(size_t pos) const
+    {
+        if (pos >= Size())
+            throw std::out_of_range("Error: out of range of mapped vector.");
+
+        return _first[pos];
+    }
+
+    // Returns a reference to the element at specified location pos. No bounds checking is performed.
+    reference operator[](size_t pos) const
+    {
+        return _first[pos];
+    }
+
+    // Calling front on an empty container is undefined.
+    reference Front() const
+    {
+        return _first[0];
+    }
+
+    // Calling back on an empty container is undefined.
+    reference Back() const
+    {
+        return _first[_count - 1];
+    }
+
+    const T* Data() const
+    {
+        return _first;
+    }
+
+private:
+#if defined(_WIN32)
+    static void* MapFile(const char* path, size_t& fileSize)
+    {
+        HANDLE file = ::CreateFileA(path, GENERIC_READ, FILE_SHARE_READ, nullptr, OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL, nullptr);
+        if (file == INVALID_HANDLE_VALUE)
+            throw std::runtime_error(std::string("Error: can not open ") + path + ".");
+
+        LARGE_INTEGER size;
+        ::GetFileSizeEx(file, &size);
+        fileSize = size_t(size.QuadPart);
+        HANDLE mappingHandle = fileSize == 0 ? nullptr : ::CreateFileMappingA(file, nullptr, PAGE_READONLY, 0, 0, nullptr);
+        ::CloseHandle(file);
+        if (mappingHandle == nullptr)
+            throw std::runtime_error(std::string("Error: can not map ") + path + ".");
+
+        // view keeps the mapping object alive.
+        void* mapping = ::MapViewOfFile(mappingHandle, FILE_MAP_READ, 0, 0, 0);
+        ::CloseHandle(mappingHandle);
+        if (mapping == nullptr)
+            throw std::runtime_error(std::string("Error: can not map ") + path + ".");
+
+        return mapping;
+    }
+
+    static void UnmapFile(void* mapping, size_t)
+    {
+        ::UnmapViewOfFile(mapping);
+    }
+#else
+    static void* MapFile(const char* path, size_t& fileSize)
+    {
+        int fd = ::open(path, O_RDONLY);
+        if (fd < 0)
+            throw std::runtime_error(std::string("Error: can not open ") + path + ".");
+
+        struct stat status;
+        if (::fstat(fd, &status) != 0 || status.st_size == 0)
+        {
+            ::close(fd);
+            throw std::runtime_error(std::string("Error: can not map ") + path + ".");
+        }
+
+        fileSize = size_t(status.st_size);
+        // mapping stays valid after fd is closed.
+        void* mapping = ::mmap(nullptr, fileSize, PROT_READ, MAP_SHARED, fd, 0);
+        ::close(fd);
+        if (mapping == MAP_FAILED)
+            throw std::runtime_error(std::string("Error: can not map ") + path + ".");
+
+        return mapping;
+    }
+
+    static void UnmapFile(void* mapping, size_t size)
+    {
+        ::munmap(mapping, size);
+    }
+#endif
+
+private:
+    void* _mapping; // whole file
+    size_t _mappedSize;
+    const T* _first; // first element in mapping
+    size_t _count;
+    uint64_t _checksum;
+};
+
+// open file for writing vector snapshot, truncating existing file. Returns -1 on failure.
+inline int OpenVectorFileForWrite(const char* path)
+{
+#if defined(_WIN32)
+    return ::_open(path, _O_WRONLY | _O_CREAT | _O_TRUNC | _O_BINARY, _S_IREAD | _S_IWRITE);
+#else
+    return ::open(path, O_WRONLY | O_CREAT | O_TRUNC, 0644);
+#endif
+}
+
+inline int OpenVectorFileForRead(const char* path)
+{
+#if defined(_WIN32)
+    return ::_open(path, _O_RDONLY | _O_BINARY);
+#else
+    return ::open(path, O_RDONLY);
+#endif
+}
+
+inline void CloseVectorFile(int fd)
+{
+#if defined(_WIN32)
+    ::_close(fd);
+#else
+    ::close(fd);
+#endif
+}
+
+// test routines for mapped vector
+void TestMappedVector()
+{
+    const char* path = "TestMappedVector.bin";
+    Vector<double> vec;
+    for (int i = 0; i < 1000; i++)
+    {
+        vec.Push_Back(i * 0.5);
+    }
+
+    int fd = OpenVectorFileForWrite(path);
+    vec.WriteTo(fd);
+    CloseVectorFile(fd);
+
+    // zero-copy view.
+    MappedVector<double> mapped(path);
+    cout << "mapped size: " << mapped.Size() << ", front: " << mapped.Front() << ", back: " << mapped.Back()
+        << ", verified: " << mapped.Verify() << endl;
+    assert(std::equal(mapped.Begin(), mapped.End(), vec.Begin()));
+    double sum = 0;
+    for (double value : mapped)
+    {
+        sum += value;
+    }
+    cout << "sum of mapped: " << sum << endl;
+
+    // copy into a vector.
+    Vector<double> loaded;
+    fd = OpenVectorFileForRead(path);
+    loaded.ReadFrom(fd);
+    CloseVectorFile(fd);
+    assert(loaded.Size() == vec.Size() && loaded[999] == 499.5);
+
+    // element type does not match.
+    try
+    {
+        MappedVector<int> wrong(path);
+        assert(false);
+    }
+    catch (const std::runtime_error& error)
+    {
+        cout << error.what() << endl;
+    }
+
+    // data offset which would misalign elements is rejected.
+    const char* crafted = "TestMappedVectorCrafted.bin";
+    double value = 1.5;
+    VectorFileHeader header = MakeVectorFileHeader(sizeof(double), 1, ChecksumBytes(&value, sizeof(value)));
+    header.dataOffset += 4;
+    char padding[4] = { 0 };
+    fd = OpenVectorFileForWrite(crafted);
+    WriteBytes(fd, &header, sizeof(header));
+    WriteBytes(fd, padding, sizeof(padding));
+    WriteBytes(fd, &value, sizeof(value));
+    CloseVectorFile(fd);
+    try
+    {
+        MappedVector<double> misaligned(crafted);
+        assert(false);
+    }
+    catch (const std::runtime_error& error)
+    {
+        cout << error.what() << endl;
+    }
+
+    // truncated file leaves loaded vector empty.
+    fd = OpenVectorFileForWrite(crafted);
+    vec.WriteTo(fd);
+    CloseVectorFile(fd);
+    fd = OpenVectorFileForRead(crafted);
+    ReadBytes(fd, &header, sizeof(header));
+    CloseVectorFile(fd);
+    fd = OpenVectorFileForWrite(crafted);
+    WriteBytes(fd, &header, sizeof(header));
+    WriteBytes(fd, vec.Data(), 10 * sizeof(double));
+    CloseVectorFile(fd);
+    fd = OpenVectorFileForRead(crafted);
+    try
+    {
+        loaded.ReadFrom(fd);
+        assert(false);
+    }
+    catch (const std::runtime_error& error)
+    {
+        cout << error.what() << endl;
+    }
+    CloseVectorFile(fd);
+    assert(loaded.Empty());
+    std::remove(crafted);
+
+    mapped.Close();
+    std::remove(path);
+
+    cout << "end of test MappedVector." << endl;
+}
+
+#endif
@@ -0,0 +1,815 @@
+//**************************************************************
+//         persistent vector, a 32-way trie sharing structure between versions
+//**************************************************************
+
+#ifndef PERSISTENTVECTOR_H
+#define PERSISTENTVECTOR_H
+
+#include <atomic>
+#include <cassert>
+#include <iostream>
+#include <iterator>
+#include <new>
+#include <stdexcept>
+#include <string>
+#include <type_traits>
+#include "Vector.h"
+
+using namespace std;
+
+// CowVector makes a version O(1) to take, but the first write to it still copies all n elements.
+// PersistentVector is never modified at all: Set/Push_Back/Pop_Back return a new version and
+// leave this one as it was, like the persistent vector of Clojure.
+//
+// elements are kept in leaves of 32, leaves hang off a trie of branches with 32 children each,
+// element pos is found by taking 5 bits of pos per level from the top. a new version copies only
+// the path from root to the changed leaf, O(log32 n) nodes, and shares every other node with the
+// old version. 1M elements need 4 levels, so a version costs about 4 small nodes instead of 1M copies.
+//
+// tail optimisation: the last, not yet full leaf is kept out of the trie as tail. Push_Back only
+// copies the tail(at most 32 elements), the trie is touched once every 32 pushes when a full tail
+// is moved into it.
+//
+// nodes are reference counted, so unreachable versions free nodes nobody else uses. counts are
+// atomic, versions can be handed to other threads as CowVector. the count lives in the node itself,
+// SharedPtr would need one more allocation for each node.
+//
+// batched edits: copying a path for every single edit is wasteful when the intermediate versions
+// are never used. Transient takes a version, modifies nodes which it created itself in place,
+// and turns into a version again with Persistent():
+//
+//   PersistentVector<int>::Transient edit(vec);
+//   for (...) edit.Push_Back(x);
+//   vec = edit.Persistent();
+template<typename T>
+class PersistentVector
+{
+public:
+    class Transient;
+    class const_iterator;
+    typedef const T& const_reference;
+
+    static const unsigned Bits = 5;
+    static const size_t BranchFactor = size_t(1) << Bits;
+    static const size_t Mask = BranchFactor - 1;
+
+private:
+    struct Node
+    {
+        std::atomic<int> refCount;
+        size_t edit; // id of the Transient allowed to modify this node in place, 0 if none
+
+        explicit Node(size_t e) :refCount(1), edit(e)
+        {
+        }
+    };
+
+    struct Branch : Node
+    {
+        Node* children[BranchFactor];
+
+        explicit Branch(size_t e) :Node(e)
+        {
+            for (size_t i = 0; i < BranchFactor; ++i)
+            {
+                children[i] = nullptr;
+            }
+        }
+    };
+
+    // leaves of the trie are always full, only tail has less than 32 elements.
+    struct Leaf : Node
+    {
+        size_t count; // constructed elements
+        typename std::aligned_storage<sizeof(T) * BranchFactor, std::alignment_of<T>::value>::type storage;
+
+        explicit Leaf(size_t e) :Node(e), count(0)
+        {
+        }
+
+        T* Elements()
+        {
+            return (T*)&storage;
+        }
+
+        const T* Elements() const
+        {
+            return (const T*)&storage;
+        }
+    };
+
+    // releases node on exception, until Detach() hands it over.
+    struct NodeHolder
+    {
+        Node* node;
+        unsigned level;
+
+        NodeHolder(Node* n, unsigned l) :node(n), level(l)
+        {
+        }
+
+        ~NodeHolder()
+        {
+            Release(node, level);
+        }
+
+        Node* Detach()
+        {
+            Node* n = node;
+            node = nullptr;
+            return n;
+        }
+    };
+
+public:
+    /*******************************************************/
+    // ctor and dtor
+    /*******************************************************/
+    PersistentVector() :_size(0), _shift(Bits), _root(nullptr), _tail(nullptr)
+    {
+    }
+
+    explicit PersistentVector(const Vector<T>& vec) :_size(0), _shift(Bits), _root(nullptr), _tail(nullptr)
+    {
+        Transient edit(*this);
+        for (const T* ptr = vec.Begin(); ptr != vec.End(); ++ptr)
+        {
+            edit.Push_Back(*ptr);
+        }
+        *this = edit.Persistent();
+    }
+
+    // O(1), shares all nodes of other.
+    PersistentVector(const PersistentVector& other)
+        :_size(other._size), _shift(other._shift), _root(Retain(other._root)), _tail(Retain(other._tail))
+    {
+    }
+
+    PersistentVector(PersistentVector&& other) :_size(0), _shift(Bits), _root(nullptr), _tail(nullptr)
+    {
+        Swap(other);
+    }
+
+    ~PersistentVector()
+    {
+        Release(_root, _shift);
+        Release(_tail, 0);
+    }
+
+    PersistentVector& operator=(const PersistentVector& other)
+    {
+        PersistentVector(other).Swap(*this);
+        return *this;
+    }
+
+    PersistentVector& operator=(PersistentVector&& other)
+    {
+        PersistentVector(std::move(other)).Swap(*this);
+        return *this;
+    }
+
+    void Swap(PersistentVector& other)
+    {
+        std::swap(_size, other._size);
+        std::swap(_shift, other._shift);
+        std::swap(_root, other._root);
+        std::swap(_tail, other._tail);
+    }
+
+    /*******************************************************/
+    // Capacity
+    /*******************************************************/
+    bool Empty() const
+    {
+        return _size == 0;
+    }
+
+    size_t Size() const
+    {
+        return _size;
+    }
+
+    /*******************************************************/
+    // Modifiers, all return a new version and keep this one unchanged.
+    /*******************************************************/
+
+    // Returns a version with element at pos replaced by value.
+    // If pos is not within the range of the container, an exception of type std::out_of_range is thrown.
+    PersistentVector Set(size_t pos, const T& value) const
+    {
+        if (pos >= _size)
+            throw std::out_of_range("Error: out of range of persistent vector.");
+
+        if (pos >= TailOffset(_size))
+        {
+            NodeHolder tail(CopyLeaf((const Leaf*)_tail, 0), 0);
+            ((Leaf*)tail.node)->Elements()[pos & Mask] = value;
+            return PersistentVector(_size, _shift, Retain(_root), tail.Detach());
+        }
+
+        Node* root = SetPath(_shift, _root, pos, value);
+        return PersistentVector(_size, _shift, root, Retain(_tail));
+    }
+
+    // Returns a version with value appended.
+    PersistentVector Push_Back(const T& value) const
+    {
+        // room in tail.
+        if (_size - TailOffset(_size) < BranchFactor)
+        {
+            NodeHolder tail(CopyLeaf((const Leaf*)_tail, 0), 0);
+            Leaf* leaf = (Leaf*)tail.node;
+            new (leaf->Elements() + leaf->count) T(value);
+            ++leaf->count;
+            return PersistentVector(_size + 1, _shift, Retain(_root), tail.Detach());
+        }
+
+        // full tail goes into the trie, value starts a new tail.
+        NodeHolder tail(NewLeaf(0), 0);
+        new (((Leaf*)tail.node)->Elements()) T(value);
+        ((Leaf*)tail.node)->count = 1;
+
+        unsigned shift = _shift;
+        Node* root = nullptr;
+        if ((_size >> Bits) > (size_t(1) << _shift))
+        {
+            // trie is full, add a level on top.
+            NodeHolder path(NewPath(_shift, Retain(_tail), 0), _shift);
+            Branch* branch = new Branch(0);
+            branch->children[0] = Retain(_root);
+            branch->children[1] = path.Detach();
+            root = branch;
+            shift += Bits;
+        }
+        else
+        {
+            root = PushTail(_shift, (const Branch*)_root);
+        }
+        return PersistentVector(_size + 1, shift, root, tail.Detach());
+    }
+
+    // Returns a version without the last element.
+    // If container is empty, an exception of type std::out_of_range is thrown.
+    PersistentVector Pop_Back() const
+    {
+        if (_size == 0)
+            throw std::out_of_range("Error: pop back of empty persistent vector.");
+
+        if (_size == 1)
+            return PersistentVector();
+
+        if (_size - TailOffset(_size) > 1)
+        {
+            NodeHolder tail(CopyLeaf((const Leaf*)_tail, 0, ((const Leaf*)_tail)->count - 1), 0);
+            return PersistentVector(_size - 1, _shift, Retain(_root), tail.Detach());
+        }
+
+        // tail becomes empty, the last leaf of the trie becomes tail.
+        NodeHolder tail(Retain(const_cast<Leaf*>(LeafFor(_size - 2))), 0);
+        Node* root = PopTail(_shift, (const Branch*)_root);
+        unsigned shift = _shift;
+        if (shift > Bits && root != nullptr && ((Branch*)root)->children[1] == nullptr)
+        {
+            // root has one child only, drop a level.
+            Node* child = Retain(((Branch*)root)->children[0]);
+            Release(root, shift);
+            root = child;
+            shift -= Bits;
+        }
+        return PersistentVector(_size - 1, shift, root, tail.Detach());
+    }
+
+    /*******************************************************/
+    // Iterators
+    /*******************************************************/
+
+    // forward iterator, looks up the trie once per leaf.
+    class const_iterator
+    {
+    public:
+        typedef std::forward_iterator_tag iterator_category;
+        typedef T value_type;
+        typedef ptrdiff_t difference_type;
+        typedef const T* pointer;
+        typedef const T& reference;
+
+        const_iterator() :_vec(nullptr), _index(0), _elements(nullptr)
+        {
+        }
+
+        const_iterator(const PersistentVector* vec, size_t index)
+            :_vec(vec), _index(index), _elements(index < vec->_size ? vec->LeafFor(index)->Elements() : nullptr)
+        {
+        }
+
+        bool operator==(const const_iterator& other) const
+        {
+            return _index == other._index;
+        }
+
+        bool operator!=(const const_iterator& other) const
+        {
+            return _index != other._index;
+        }
+
+        reference operator*() const
+        {
+            return _elements[_index & Mask];
+        }
+
+        pointer operator->() const
+        {
+            return _elements + (_index & Mask);
+        }
+
+        // pre-increment
+        const_iterator& operator++()
+        {
+            ++_index;
+            if ((_index & Mask) == 0 && _index < _vec->_size)
+            {
+                _elements = _vec->LeafFor(_index)->Elements();
+            }
+            return *this;
+        }
+
+        // post-increment
+        const_iterator operator++(int)
+        {
+            const_iterator temp = *this;
+            ++(*this);
+            return temp;
+        }
+
+    private:
+        const PersistentVector* _vec;
+        size_t _index;
+        const T* _elements; // leaf holding element _index
+    };
+
+    // specially for "Range for". Need begin(),end().
+    const_iterator begin() const
+    {
+        return Begin();
+    }
+
+    const_iterator end() const
+    {
+        return End();
+    }
+
+    const_iterator Begin() const
+    {
+        return const_iterator(this, 0);
+    }
+
+    const_iterator End() const
+    {
+        return const_iterator(this, _size);
+    }
+
+    /*******************************************************/
+    // Accessor
+    /*******************************************************/
+
+    // Returns a reference to the element at specified location pos, with bounds checking.
+    // If pos is not within the range of the container, an exception of type std::out_of_range is thrown.
+    const_reference At(size_t pos) const
+    {
+        if (pos >= _size)
+            throw std::out_of_range("Error: out of range of persistent vector.");
+
+        return (*this)[pos];
+    }
+
+    // Returns a reference to the element at specified location pos. No bounds checking is performed.
+    const_reference operator[](size_t pos) const
+    {
+        return LeafFor(pos)->Elements()[pos & Mask];
+    }
+
+    const_reference Front() const
+    {
+        return (*this)[0];
+    }
+
+    const_reference Back() const
+    {
+        return (*this)[_size - 1];
+    }
+
+    /*******************************************************/
+    // Transient
+    /*******************************************************/
+
+    // mutable editor of a version for batched edits. the first edit of a node copies it as usual
+    // and marks the copy with the id of this Transient, later edits of a marked node modify it in place,
+    // so n pushes cost O(n) rather than O(n log32 n) path copies.
+    // Persistent() gives up the id, marked nodes become immutable parts of the returned version.
+    // the version Transient starts from is never modified.
+    class Transient
+    {
+    public:
+        explicit Transient(const PersistentVector& vec)
+            :_size(vec._size), _shift(vec._shift), _root(Retain(vec._root)), _tail(Retain(vec._tail)), _edit(NextEditId())
+        {
+        }
+
+        ~Transient()
+        {
+            Release(_root, _shift);
+            Release(_tail, 0);
+        }
+
+        Transient(const Transient&) = delete;
+        Transient& operator=(const Transient&) = delete;
+
+        size_t Size() const
+        {
+            return _size;
+        }
+
+        const_reference operator[](size_t pos) const
+        {
+            return LeafFor(_root, _shift, _tail, _size, pos)->Elements()[pos & Mask];
+        }
+
+        // If pos is not within the range of the container, an exception of type std::out_of_range is thrown.
+        void Set(size_t pos, const T& value)
+        {
+            if (pos >= _size)
+                throw std::out_of_range("Error: out of range of persistent vector.");
+
+            if (pos >= TailOffset(_size))
+            {
+                EditableLeaf(_tail)->Elements()[pos & Mask] = value;
+                return;
+            }
+
+            Node** slot = &_root;
+            for (unsigned level = _shift; level > 0; level -= Bits)
+            {
+                slot = &EditableBranch(*slot, level)->children[(pos >> level) & Mask];
+            }
+            EditableLeaf(*slot)->Elements()[pos & Mask] = value;
+        }
+
+        void Push_Back(const T& value)
+        {
+            if (_size - TailOffset(_size) < BranchFactor)
+            {
+                Leaf* tail = EditableLeaf(_tail);
+                new (tail->Elements() + tail->count) T(value);
+                ++tail->count;
+                ++_size;
+                return;
+            }
+
+            NodeHolder tail(NewLeaf(_edit), 0);
+            new (((Leaf*)tail.node)->Elements()) T(value);
+            ((Leaf*)tail.node)->count = 1;
+
+            if ((_size >> Bits) > (size_t(1) << _shift))
+            {
+                NodeHolder path(NewPath(_shift, Retain(_tail), _edit), _shift);
+                Branch* root = new Branch(_edit);
+                root->children[0] = _root;
+                root->children[1] = path.Detach();
+                _root = root;
+                _shift += Bits;
+            }
+            else
+            {
+                // walk down to the first missing node on the path of the full tail.
+                Node** slot = &_root;
+                unsigned level = _shift;
+                for (;;)
+                {
+                    slot = &EditableBranch(*slot, level)->children[((_size - 1) >> level) & Mask];
+                    if (level == Bits || *slot == nullptr)
+                        break;
+                    level -= Bits;
+                }
+                *slot = NewPath(level - Bits, Retain(_tail), _edit);
+            }
+
+            // full tail is referenced by the trie now.
+            Release(_tail, 0);
+            _tail = tail.Detach();
+            ++_size;
+        }
+
+        // Returns the edited version, this Transient becomes empty.
+        PersistentVector Persistent()
+        {
+            PersistentVector result(_size, _shift, _root, _tail);
+            _size = 0;
+            _shift = Bits;
+            _root = nullptr;
+            _tail = nullptr;
+            _edit = NextEditId();
+            return result;
+        }
+
+    private:
+        // node in slot if this Transient marked it, otherwise a marked copy replacing it in slot.
+        Branch* EditableBranch(Node*& slot, unsigned level)
+        {
+            if (slot != nullptr && slot->edit == _edit)
+                return (Branch*)slot;
+
+            Branch* copy = CopyBranch((const Branch*)slot, _edit);
+            Release(slot, level);
+            slot = copy;
+            return copy;
+        }
+
+        Leaf* EditableLeaf(Node*& slot)
+        {
+            if (slot != nullptr && slot->edit == _edit)
+                return (Leaf*)slot;
+
+            Leaf* copy = CopyLeaf((const Leaf*)slot, _edit);
+            Release(slot, 0);
+            slot = copy;
+            return copy;
+        }
+
+    private:
+        size_t _size;
+        unsigned _shift;
+        Node* _root;
+        Node* _tail;
+        size_t _edit;
+    };
+
+private:
+    // takes over root and tail.
+    PersistentVector(size_t size, unsigned shift, Node* root, Node* tail) :_size(size), _shift(shift), _root(root), _tail(tail)
+    {
+    }
+
+    // index of the first element in tail.
+    static size_t TailOffset(size_t size)
+    {
+        return size < BranchFactor ? 0 : ((size - 1) >> Bits) << Bits;
+    }
+
+    static const Leaf* LeafFor(const Node* root, unsigned shift, const Node* tail, size_t size, size_t pos)
+    {
+        if (pos >= TailOffset(size))
+            return (const Leaf*)tail;
+
+        const Node* node = root;
+        for (unsigned level = shift; level > 0; level -= Bits)
+        {
+            node = ((const Branch*)node)->children[(pos >> level) & Mask];
+        }
+        return (const Leaf*)node;
+    }
+
+    const Leaf* LeafFor(size_t pos) const
+    {
+        return LeafFor(_root, _shift, _tail, _size, pos);
+    }
+
+    // copy of path from node at level down to leaf of pos, with element at pos replaced.
+    static Node* SetPath(unsigned level, const Node* node, size_t pos, const T& value)
+    {
+        if (level == 0)
+        {
+            NodeHolder leaf(CopyLeaf((const Leaf*)node, 0), 0);
+            ((Leaf*)leaf.node)->Elements()[pos & Mask] = value;
+            return leaf.Detach();
+        }
+
+        size_t index = (pos >> level) & Mask;
+        NodeHolder child(SetPath(level - Bits, ((const Branch*)node)->children[index], pos, value), level - Bits);
+        Branch* branch = CopyBranch((const Branch*)node, 0);
+        Release(branch->children[index], level - Bits);
+        branch->children[index] = child.Detach();
+        return branch;
+    }
+
+    // copy of path from node at level with the full tail added as leaf _size - 1.
+    Node* PushTail(unsigned level, const Branch* node) const
+    {
+        size_t index = ((_size - 1) >> level) & Mask;
+        Node* old = node == nullptr ? nullptr : node->children[index];
+        NodeHolder child(nullptr, level - Bits);
+        if (level == Bits)
+            child.node = Retain(_tail);
+        else if (old != nullptr)
+            child.node = PushTail(level - Bits, (const Branch*)old);
+        else
+            child.node = NewPath(level - Bits, Retain(_tail), 0);
+
+        Branch* branch = CopyBranch(node, 0);
+        Release(branch->children[index], level - Bits);
+        branch->children[index] = child.Detach();
+        return branch;
+    }
+
+    // copy of path from node at level without leaf of element _size - 2 and beyond,
+    // null if nothing is left under node.
+    Node* PopTail(unsigned level, const Branch* node) const
+    {
+        size_t index = ((_size - 2) >> level) & Mask;
+        NodeHolder child(nullptr, level - Bits);
+        if (level > Bits)
+        {
+            child.node = PopTail(level - Bits, (const Branch*)node->children[index]);
+            if (child.node == nullptr && index == 0)
+                return nullptr;
+        }
+        else if (index == 0)
+        {
+            return nullptr;
+        }
+
+        Branch* branch = CopyBranch(node, 0);
+        Release(branch->children[index], level - Bits);
+        branch->children[index] = child.Detach();
+        return branch;
+    }
+
+    /*******************************************************/
+    // nodes
+    /*******************************************************/
+    template<typename NodeType>
+    static NodeType* Retain(NodeType* node)
+    {
+        if (node != nullptr)
+        {
+            node->refCount.fetch_add(1, std::memory_order_relaxed);
+        }
+        return node;
+    }
+
+    // drops one reference of node at level, frees it with its subtree when it was the last one.
+    static void Release(Node* node, unsigned level)
+    {
+        if (node == nullptr || node->refCount.fetch_sub(1, std::memory_order_acq_rel) != 1)
+            return;
+
+        if (level == 0)
+        {
+            Leaf* leaf = (Leaf*)node;
+            for (size_t i = 0; i < leaf->count; ++i)
+            {
+                leaf->Elements()[i].~T();
+            }
+            delete leaf;
+        }
+        else
+        {
+            Branch* branch = (Branch*)node;
+            for (size_t i = 0; i < BranchFactor; ++i)
+            {
+                Release(branch->children[i], level - Bits);
+            }
+            delete branch;
+        }
+    }
+
+    static Leaf* NewLeaf(size_t edit)
+    {
+        return new Leaf(edit);
+    }
+
+    // copy of first count elements of leaf(all of them by default), null leaf is empty.
+    static Leaf* CopyLeaf(const Leaf* leaf, size_t edit, size_t count = size_t(-1))
+    {
+        if (leaf == nullptr)
+            return NewLeaf(edit);
+
+        if (count > leaf->count)
+            count = leaf->count;
+
+        NodeHolder copy(NewLeaf(edit), 0);
+        Leaf* result = (Leaf*)copy.node;
+        for (; result->count < count; ++result->count)
+        {
+            new (result->Elements() + result->count) T(leaf->Elements()[result->count]);
+        }
+        return (Leaf*)copy.Detach();
+    }
+
+    // copy sharing all children of branch, null branch is empty.
+    static Branch* CopyBranch(const Branch* branch, size_t edit)
+    {
+        Branch* copy = new Branch(edit);
+        if (branch != nullptr)
+        {
+            for (size_t i = 0; i < BranchFactor; ++i)
+            {
+                copy->children[i] = Retain(branch->children[i]);
+            }
+        }
+        return copy;
+    }
+
+    // chain of branches from level down to node, takes over node.
+    static Node* NewPath(unsigned level, Node* node, size_t edit)
+    {
+        NodeHolder path(node, 0);
+        for (unsigned l = Bits; l <= level; l += Bits)
+        {
+            Branch* branch = new Branch(edit);
+            branch->children[0] = path.node;
+            path.node = branch;
+            path.level = l;
+        }
+        return path.Detach();
+    }
+
+    static size_t NextEditId()
+    {
+        return nextEditId.fetch_add(1, std::memory_order_relaxed);
+    }
+
+private:
+    size_t _size;
+    unsigned _shift; // 5 bits per level, level of root
+    Node* _root;     // trie of all elements before tail, null when they all fit in tail
+    Node* _tail;     // last leaf, not in the trie
+
+    static std::atomic<size_t> nextEditId; // ids are never reused, 0 marks immutable nodes
+};
+
+template<typename T>
+std::atomic<size_t> PersistentVector<T>::nextEditId(1);
+
+// test routines for persistent vector
+void TestPersistentVector()
+{
+    // every version is kept and checked after all later versions are made.
+    const int count = 2000;
+    Vector<PersistentVector<int>> versions;
+    versions.Push_Back(PersistentVector<int>());
+    for (int i = 0; i < count; i++)
+    {
+        versions.Push_Back(versions.Back().Push_Back(i));
+    }
+    for (int n = 0; n <= count; n++)
+    {
+        const PersistentVector<int>& version = versions[n];
+        assert(version.Size() == size_t(n));
+        int expected = 0;
+        for (int value : version)
+        {
+            assert(value == expected++);
+        }
+    }
+
+    // Set copies a path only.
+    PersistentVector<int> full = versions.Back();
+    PersistentVector<int> changed = full.Set(0, -1).Set(1500, -2).Set(count - 1, -3);
+    assert(full[0] == 0 && full[1500] == 1500 && full[count - 1] == count - 1);
+    assert(changed[0] == -1 && changed[1500] == -2 && changed[count - 1] == -3 && changed[1] == 1);
+
+    // pop back to empty through all shapes of trie.
+    PersistentVector<int> popped = full;
+    for (int n = count; n > 0; n--)
+    {
+        assert(popped.Size() == size_t(n) && popped.Back() == n - 1);
+        popped = popped.Pop_Back();
+    }
+    assert(popped.Empty() && full.Size() == size_t(count));
+
+    // transient edits do not change the version they start from.
+    PersistentVector<string> names;
+    names = names.Push_Back("zero");
+    PersistentVector<string>::Transient edit(names);
+    for (int i = 1; i < 100; i++)
+    {
+        edit.Push_Back(to_string(i));
+    }
+    edit.Set(0, "first");
+    edit.Set(50, "middle");
+    PersistentVector<string> edited = edit.Persistent();
+    assert(names.Size() == 1 && names[0] == "zero");
+    assert(edited.Size() == 100 && edited[0] == "first" && edited[50] == "middle" && edited[99] == "99");
+
+    // editing again after Persistent() leaves edited unchanged.
+    PersistentVector<string>::Transient again(edited);
+    again.Set(99, "last");
+    PersistentVector<string> edited2 = again.Persistent();
+    assert(edited[99] == "99" && edited2[99] == "last");
+
+    try
+    {
+        edited.At(100);
+        assert(false);
+    }
+    catch (const std::out_of_range& error)
+    {
+        cout << error.what() << endl;
+    }
+
+    cout << "versions: " << versions.Size() << ", size of last: " << full.Size() << ", edited front: " << edited.Front() << endl;
+
+    cout << "end of test PersistentVector." << endl;
+}
+
+#endif
@@ -0,0 +1,533 @@
+//**************************************************************
+//         vector with inline storage for small number of elements
+//**************************************************************
+
+#ifndef SMALLVECTOR_H
+#define SMALLVECTOR_H
+
+#include <algorithm>
+#include <iostream>
+#include <iterator>
+#include <string>
+#include <type_traits>
+#include "..\Memory\Allocator.h"
+#include "Uninitialized.h"
+#include "Vector.h"
+
+using namespace std;
+
+// SmallVector keeps up to N elements in a buffer inside the object itself, and only
+// allocates heap storage(through Allocator<T>) when it grows beyond N, like llvm::SmallVector.
+// most vectors only hold a few elements, for them no allocation happens at all.
+
+// it has same interface as Vector. Note that unlike Vector, moving a SmallVector whose
+// elements are still inline has to relocate elements, so it is O(N) rather than O(1).
+template<typename T, size_t N>
+class SmallVector
+{
+    static_assert(N > 0, "SmallVector needs inline capacity greater than 0.");
+
+    // N objects of T with aligned storage, objects are constructed on demand.
+    typedef typename std::aligned_storage<sizeof(T) * N, std::alignment_of<T>::value>::type InlineBuffer;
+
+public:
+    // same as Vector, elements are consecutive so raw pointer is enough for iterator.
+    typedef T* iterator;
+    typedef const T* const_iterator;
+    typedef T& reference;
+    typedef const T& const_reference;
+
+    /*******************************************************/
+    // ctor and dtor
+    /*******************************************************/
+    SmallVector()
+    {
+        ResetToInline();
+    }
+
+    SmallVector(size_t count, const T& value)
+    {
+        ResetToInline();
+        Insert(End(), count, value);
+    }
+
+    SmallVector(iterator first, iterator last)
+    {
+        ResetToInline();
+        Reserve(last - first);
+        _last = std::uninitialized_copy(first, last, _first);
+    }
+
+    SmallVector(const SmallVector& other)
+    {
+        ResetToInline();
+        Reserve(other.Size());
+        _last = std::uninitialized_copy(other.Begin(), other.End(), _first);
+    }
+
+    SmallVector(SmallVector&& other)
+    {
+        ResetToInline();
+        Assign_rv(std::forward<SmallVector>(other));
+    }
+
+    ~SmallVector()
+    {
+        Tidy();
+    }
+
+    SmallVector& operator=(const SmallVector& other)
+    {
+        if (this != &other)
+        {
+            Clear();
+            Reserve(other.Size());
+            _last = std::uninitialized_copy(other.Begin(), other.End(), _first);
+        }
+
+        return *this;
+    }
+
+    SmallVector& operator=(SmallVector&& other)
+    {
+        if (this != &other)
+        {
+            // free old storage.
+            Tidy();
+            Assign_rv(std::forward<SmallVector>(other));
+        }
+
+        return *this;
+    }
+
+    /*******************************************************/
+    // Capacity
+    /*******************************************************/
+    bool Empty() const
+    {
+        return _first == _last;
+    }
+
+    // Returns the number of elements in the container
+    size_t Size() const
+    {
+        return _last - _first;
+    }
+
+    // Returns the number of elements that the container has currently allocated space for.
+    // it is N before spilling to heap.
+    size_t Capacity() const
+    {
+        return _end - _first;
+    }
+
+    // whether elements are still kept in the inline buffer.
+    bool IsInline() const
+    {
+        return _first == InlineFirst();
+    }
+
+    // Increase the capacity to a value that's greater or equal to new_cap,
+    // moves elements from inline buffer to heap storage if new_cap is greater than N.
+    void Reserve(size_t newCapacity)
+    {
+        if (newCapacity <= Capacity())
+            return;
+
+        Reallocate(newCapacity);
+    }
+
+    /*******************************************************/
+    // Modifiers
+    /*******************************************************/
+
+    // Removes all elements from the container. Leaves the capacity() unchanged.
+    void Clear()
+    {
+        Destroy(_first, _last);
+        _last = _first;
+    }
+
+    // inserts value before pos.
+    iterator Insert(iterator pos, const T& value)
+    {
+        return Emplace(pos, value);
+    }
+
+    // inserts value before pos by moving it.
+    iterator Insert(iterator pos, T&& value)
+    {
+        return Emplace(pos, std::move(value));
+    }
+
+    // inserts count copies of value before pos.
+    iterator Insert(iterator pos, size_t count, const T& value)
+    {
+        size_t offset = pos - _first;
+
+        if (count == 0)
+        {
+            ;
+        }
+        else if (count <= size_t(_end - _last))
+        {
+            // value could refer to an element which is shifted below, keep a copy of it.
+            T copy(value);
+            size_t moveSize = _last - pos;
+            iterator oldLast = _last;
+
+            if (moveSize > count)
+            {
+                // 11p22000 insert 2 X:
+                // move construct last count elements to raw slots: 11p22022
+                // shift left ones backward on live slots:          11pp2p22
+                // assign values:                                   11XXp22
+                _last = std::uninitialized_copy(std::make_move_iterator(oldLast - count), std::make_move_iterator(oldLast), oldLast);
+                std::move_backward(pos, oldLast - count, oldLast);
+                std::fill_n(pos, count, copy);
+            }
+            else
+            {
+                // 11p20000 insert 3 X:
+                // fill raw slots which are beyond moved elements: 11p20X00
+                // move construct elements after pos to the end:   11p20Xp2
+                // assign values on old slots:                     11XXXp2
+                _last = std::uninitialized_fill_n(oldLast, count - moveSize, copy);
+                _last = std::uninitialized_copy(std::make_move_iterator(pos), std::make_move_iterator(oldLast), _last);
+                std::fill(pos, oldLast, copy);
+            }
+        }
+        else
+        {
+            size_t newCapacity = GrowCapacity(Size() + count);
+            iterator newFirst = alloc.allocate(newCapacity);
+            try
+            {
+                std::uninitialized_fill_n(newFirst + offset, count, value);
+            }
+            catch (...)
+            {
+                alloc.deallocate(newFirst, newCapacity);
+                throw;
+            }
+            RelocateAround(newFirst, newCapacity, offset, count);
+        }
+
+        return Begin() + offset;
+    }
+
+    iterator Erase(iterator pos)
+    {
+        return Erase(pos, pos + 1);
+    }
+
+    iterator Erase(iterator first, iterator last)
+    {
+        if (first != last)
+        {
+            iterator newLast = std::move(last, _last, first);
+            Destroy(newLast, _last);
+            _last = newLast;
+        }
+
+        return first;
+    }
+
+    void Push_Back(const T& value)
+    {
+        Emplace_Back(value);
+    }
+
+    void Push_Back(T&& value)
+    {
+        Emplace_Back(std::move(value));
+    }
+
+    void Pop_back()
+    {
+        Destroy(_last - 1, _last);
+        --_last;
+    }
+
+    // constructs element in-place.
+    template<class... Args>
+    iterator Emplace(iterator pos, Args&&... args)
+    {
+        size_t offset = pos - _first;
+
+        if (_last == _end)
+        {
+            size_t newCapacity = GrowCapacity(Size() + 1);
+            iterator newFirst = alloc.allocate(newCapacity);
+            try
+            {
+                alloc.construct(newFirst + offset, std::forward<Args>(args)...);
+            }
+            catch (...)
+            {
+                alloc.deallocate(newFirst, newCapacity);
+                throw;
+            }
+            RelocateAround(newFirst, newCapacity, offset, 1);
+        }
+        else if (pos == _last)
+        {
+            alloc.construct(_last, std::forward<Args>(args)...);
+            ++_last;
+        }
+        else
+        {
+            // args could refer to an element which is shifted below, construct value firstly.
+            T value(std::forward<Args>(args)...);
+            alloc.construct(_last, std::move(*(_last - 1)));
+            ++_last;
+            std::move_backward(pos, _last - 2, _last - 1);
+            *pos = std::move(value);
+        }
+
+        return Begin() + offset;
+    }
+
+    // constructs an element in-place at the end.
+    template<class... Args>
+    reference Emplace_Back(Args&&... args)
+    {
+        if (_last != _end)
+        {
+            alloc.construct(_last, std::forward<Args>(args)...);
+            ++_last;
+            return Back();
+        }
+
+        return *Emplace(End(), std::forward<Args>(args)...);
+    }
+
+    /*******************************************************/
+    // Iterators
+    /*******************************************************/
+
+    // specially for "Range for". Need begin(),end().
+    iterator begin()
+    {
+        return _first;
+    }
+
+    iterator end()
+    {
+        return _last;
+    }
+
+    iterator Begin()
+    {
+        return _first;
+    }
+
+    iterator Begin() const
+    {
+        return _first;
+    }
+
+    const_iterator CBegin()
+    {
+        return _first;
+    }
+
+    iterator End()
+    {
+        return _last;
+    }
+
+    iterator End() const
+    {
+        return _last;
+    }
+
+    const_iterator CEnd()
+    {
+        return _last;
+    }
+
+    /*******************************************************/
+    // Accessor
+    /*******************************************************/
+
+    // Returns a reference to the element at specified location pos, with bounds checking.
+    reference At(size_t pos)
+    {
+        if (pos >= Size())
+            throw std::out_of_range("Error: out of range of small vector.");
+
+        return *(Begin() + pos);
+    }
+
+    // Returns a reference to the element at specified location pos. No bounds checking is performed.
+    reference operator[](size_t pos)
+    {
+        return *(Begin() + pos);
+    }
+
+    reference Front()
+    {
+        return *Begin();
+    }
+
+    reference Back()
+    {
+        return *(End() - 1);
+    }
+
+    T* Data()
+    {
+        return _first;
+    }
+
+private:
+    iterator InlineFirst() const
+    {
+        return reinterpret_cast<iterator>(const_cast<InlineBuffer*>(&buffer));
+    }
+
+    // make iterators point to empty inline buffer.
+    void ResetToInline()
+    {
+        _first = _last = InlineFirst();
+        _end = _first + N;
+    }
+
+    // grow 50% as Vector, but at least to hold minimalCapacity elements.
+    size_t GrowCapacity(size_t minimalCapacity) const
+    {
+        return GrowthFactor15::NewCapacity(alloc, Capacity(), minimalCapacity);
+    }
+
+    void Reallocate(size_t newCapacity)
+    {
+        iterator newFirst = alloc.allocate(newCapacity);
+        RelocateAround(newFirst, newCapacity, Size(), 0);
+    }
+
+    // move to new heap storage where [offset, offset+count) are already constructed,
+    // old elements before/after offset are relocated around them.
+    // if a copy throws, the new storage and objects in it are freed and old elements are untouched.
+    void RelocateAround(iterator newFirst, size_t newCapacity, size_t offset, size_t count)
+    {
+        iterator pos = _first + offset;
+        iterator newLast;
+        try
+        {
+            newLast = UninitializedRelocateAround(_first, pos, _last, newFirst, count);
+        }
+        catch (...)
+        {
+            alloc.deallocate(newFirst, newCapacity);
+            throw;
+        }
+        FreeStorage();
+
+        _first = newFirst;
+        _last = newLast;
+        _end = _first + newCapacity;
+    }
+
+    void Destroy(iterator first, iterator last)
+    {
+        for (; first != last; ++first)
+        {
+            alloc.destroy(first);
+        }
+    }
+
+    // deallocate heap storage, inline buffer does not need to free.
+    void FreeStorage()
+    {
+        if (!IsInline())
+        {
+            alloc.deallocate(_first, Capacity());
+        }
+    }
+
+    // tidy all storage, back to empty inline buffer.
+    void Tidy()
+    {
+        Destroy(_first, _last);
+        FreeStorage();
+        ResetToInline();
+    }
+
+    // take over elements of other, this must be empty and inline.
+    void Assign_rv(SmallVector&& other)
+    {
+        if (other.IsInline())
+        {
+            // inline buffer cannot be stolen, relocate its elements one by one.
+            _last = UninitializedRelocate(other._first, other._last, _first);
+            other._last = other._first;
+        }
+        else
+        {
+            // heap storage can be stolen as Vector.
+            _first = other._first;
+            _last = other._last;
+            _end = other._end;
+            other.ResetToInline();
+        }
+    }
+
+private:
+    Allocator<T> alloc;
+
+    iterator _first;
+    iterator _last;
+    iterator _end;
+
+    InlineBuffer buffer;
+};
+
+// test routines for small vector
+void TestSmallVector()
+{
+    SmallVector<int, 4> vec1;
+    for (int i = 1; i < 5; i++)
+    {
+        vec1.Push_Back(i);
+    }
+    cout << "inline: " << vec1.IsInline() << ", capacity: " << vec1.Capacity() << endl;
+    PrintVector(vec1);
+
+    // spill to heap
+    vec1.Push_Back(5);
+    cout << "inline: " << vec1.IsInline() << ", capacity: " << vec1.Capacity() << endl;
+    PrintVector(vec1);
+
+    vec1.Insert(vec1.Begin() + 1, 2, 9);
+    PrintVector(vec1);
+
+    vec1.Insert(vec1.Begin(), 8);
+    PrintVector(vec1);
+
+    vec1.Erase(vec1.Begin());
+    PrintVector(vec1);
+
+    vec1.Erase(vec1.Begin() + 1, vec1.Begin() + 3);
+    PrintVector(vec1);
+
+    SmallVector<string, 2> vec2;
+    vec2.Emplace_Back("a");
+    vec2.Emplace_Back(3, 'b');
+    SmallVector<string, 2> vec3(std::move(vec2)); // still inline, relocate elements.
+    PrintVector(vec3);
+
+    vec3.Emplace(vec3.Begin(), "c");
+    SmallVector<string, 2> vec4(vec3);
+    SmallVector<string, 2> vec5(std::move(vec3)); // on heap, steal storage.
+    PrintVector(vec4);
+    PrintVector(vec5);
+
+    vec5.Clear();
+    vec5.Reserve(10);
+    cout << "empty: " << vec5.Empty() << ", capacity: " << vec5.Capacity() << endl;
+
+    cout << "end of test SmallVector." << endl;
+}
+
+#endif
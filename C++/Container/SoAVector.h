@@ -0,0 +1,343 @@
+//**************************************************************
+//         structure of arrays vector, one array per field
+//**************************************************************
+
+#ifndef SOAVECTOR_H
+#define SOAVECTOR_H
+
+#include <cassert>
+#include <iostream>
+#include <string>
+#include <tuple>
+#include <utility>
+#include "Vector.h"
+#include "VectorAlgorithm.h"
+#include "..\Memory\AlignedAllocator.h"
+
+using namespace std;
+
+// Vector<Particle> stores structs one after another(array of structures):
+//   x y z id | x y z id | x y z id ...
+// a loop reading only x still pulls y, z and id into cache, 3/4 of every cache line is wasted,
+// and SIMD code has to gather x from strided positions.
+// SoAVector<float, float, float, int> stores each field in its own array(structure of arrays):
+//   x x x x ... | y y y y ... | z z z z ... | id id id id ...
+// a loop over one field reads contiguous memory, and the column can be handed to SIMD kernels
+// of VectorAlgorithm directly. each column is a Vector aligned to cache line, so columns grow
+// by the growth policy of Vector and all of them keep the same size.
+
+// compile time sequence of indices 0, 1, ..., N-1 to expand columns, as std::index_sequence of C++14.
+template<size_t... Is>
+struct IndexSequence
+{
+};
+
+template<size_t N, size_t... Is>
+struct MakeIndexSequence : MakeIndexSequence<N - 1, N - 1, Is...>
+{
+};
+
+template<size_t... Is>
+struct MakeIndexSequence<0, Is...>
+{
+    typedef IndexSequence<Is...> type;
+};
+
+template<typename... Ts>
+class SoAVector
+{
+public:
+    // a row is a tuple of references into each column, so it can be read and assigned in place.
+    typedef std::tuple<Ts&...> Row;
+
+    // column I is an aligned Vector of I-th field type.
+    template<size_t I>
+    struct ColumnType
+    {
+        typedef typename std::tuple_element<I, std::tuple<Ts...>>::type value_type;
+        typedef Vector<value_type, AlignedAllocator<value_type>> type;
+    };
+
+    // row iterator, dereference gives a Row proxy of references.
+    class iterator
+    {
+    public:
+        iterator() :vec(nullptr), index(0)
+        {
+        }
+
+        iterator(SoAVector* v, size_t i) :vec(v), index(i)
+        {
+        }
+
+        bool operator==(const iterator& other) const
+        {
+            return index == other.index;
+        }
+
+        bool operator!=(const iterator& other) const
+        {
+            return index != other.index;
+        }
+
+        Row operator*() const
+        {
+            return (*vec)[index];
+        }
+
+        // pre-increment
+        iterator& operator++()
+        {
+            ++index;
+            return *this;
+        }
+
+        // post-increment
+        iterator operator++(int)
+        {
+            iterator temp = *this;
+            ++index;
+            return temp;
+        }
+
+        size_t Index() const
+        {
+            return index;
+        }
+
+    private:
+        SoAVector* vec;
+        size_t index;
+    };
+
+    /*******************************************************/
+    // Capacity
+    /*******************************************************/
+    bool Empty() const
+    {
+        return Size() == 0;
+    }
+
+    size_t Size() const
+    {
+        return std::get<0>(columns).Size();
+    }
+
+    size_t Capacity() const
+    {
+        return std::get<0>(columns).Capacity();
+    }
+
+    void Reserve(size_t newCapacity)
+    {
+        ForEachColumn(ReserveColumn(newCapacity), std::integral_constant<size_t, 0>());
+    }
+
+    /*******************************************************/
+    // Modifiers
+    /*******************************************************/
+
+    // appends one row, one value per column.
+    // if a column throws, values already pushed to former columns are popped, so columns keep the same size.
+    template<typename... Args>
+    void Push_Back(Args&&... values)
+    {
+        static_assert(sizeof...(Args) == sizeof...(Ts), "one value per column.");
+        PushColumns<0>(std::forward<Args>(values)...);
+    }
+
+    void Pop_Back()
+    {
+        ForEachColumn(PopColumn(), std::integral_constant<size_t, 0>());
+    }
+
+    // resizes all columns, new rows are value-initialized.
+    void Resize(size_t count)
+    {
+        ForEachColumn(ResizeColumn(count), std::integral_constant<size_t, 0>());
+    }
+
+    void Clear()
+    {
+        ForEachColumn(ClearColumn(), std::integral_constant<size_t, 0>());
+    }
+
+    /*******************************************************/
+    // Iterators
+    /*******************************************************/
+
+    // specially for "Range for". Need begin(),end().
+    iterator begin()
+    {
+        return Begin();
+    }
+
+    iterator end()
+    {
+        return End();
+    }
+
+    iterator Begin()
+    {
+        return iterator(this, 0);
+    }
+
+    iterator End()
+    {
+        return iterator(this, Size());
+    }
+
+    /*******************************************************/
+    // Accessor
+    /*******************************************************/
+
+    // Returns the row at pos as tuple of references. No bounds checking is performed.
+    Row operator[](size_t pos)
+    {
+        return MakeRow(pos, typename MakeIndexSequence<sizeof...(Ts)>::type());
+    }
+
+    // Returns field I of row pos.
+    template<size_t I>
+    typename ColumnType<I>::value_type& Get(size_t pos)
+    {
+        return std::get<I>(columns)[pos];
+    }
+
+    // Returns column I as a whole, e.g. to scan it with VectorAlgorithm: Sum(soa.Column<0>()).
+    // column is const since its size must stay the same as other columns.
+    template<size_t I>
+    const typename ColumnType<I>::type& Column() const
+    {
+        return std::get<I>(columns);
+    }
+
+    // Returns pointer to the contiguous array of column I, its elements can be modified in place.
+    template<size_t I>
+    typename ColumnType<I>::value_type* Data()
+    {
+        return std::get<I>(columns).Data();
+    }
+
+private:
+    template<size_t... Is>
+    Row MakeRow(size_t pos, IndexSequence<Is...>)
+    {
+        return Row(std::get<Is>(columns)[pos]...);
+    }
+
+    template<size_t I, typename Arg, typename... Rest>
+    void PushColumns(Arg&& value, Rest&&... rest)
+    {
+        std::get<I>(columns).Push_Back(std::forward<Arg>(value));
+        try
+        {
+            PushColumns<I + 1>(std::forward<Rest>(rest)...);
+        }
+        catch (...)
+        {
+            std::get<I>(columns).Pop_back();
+            throw;
+        }
+    }
+
+    template<size_t I>
+    void PushColumns()
+    {
+    }
+
+    // call function on every column, recursion stops after the last column.
+    template<typename Function, size_t I>
+    void ForEachColumn(const Function& function, std::integral_constant<size_t, I>)
+    {
+        function(std::get<I>(columns));
+        ForEachColumn(function, std::integral_constant<size_t, I + 1>());
+    }
+
+    template<typename Function>
+    void ForEachColumn(const Function&, std::integral_constant<size_t, sizeof...(Ts)>)
+    {
+    }
+
+    // column operations, function objects since lambda can not be generic in C++11.
+    struct ReserveColumn
+    {
+        explicit ReserveColumn(size_t c) :capacity(c)
+        {
+        }
+
+        template<typename Column>
+        void operator()(Column& column) const
+        {
+            column.Reserve(capacity);
+        }
+
+        size_t capacity;
+    };
+
+    struct ResizeColumn
+    {
+        explicit ResizeColumn(size_t c) :count(c)
+        {
+        }
+
+        template<typename Column>
+        void operator()(Column& column) const
+        {
+            column.Resize(count);
+        }
+
+        size_t count;
+    };
+
+    struct PopColumn
+    {
+        template<typename Column>
+        void operator()(Column& column) const
+        {
+            column.Pop_back();
+        }
+    };
+
+    struct ClearColumn
+    {
+        template<typename Column>
+        void operator()(Column& column) const
+        {
+            column.Clear();
+        }
+    };
+
+private:
+    std::tuple<Vector<Ts, AlignedAllocator<Ts>>...> columns;
+};
+
+// test routines for SoAVector
+void TestSoAVector()
+{
+    SoAVector<int, float, string> table;
+    table.Push_Back(1, 1.5f, "one");
+    table.Push_Back(2, 2.5f, "two");
+    table.Push_Back(3, 3.5f, string("three"));
+
+    // rows are tuples of references, they can be modified in place.
+    std::get<1>(table[1]) = 20.5f;
+    table.Get<2>(0) = "ONE";
+    for (auto row : table)
+    {
+        cout << std::get<0>(row) << ":" << std::get<1>(row) << ":" << std::get<2>(row) << " ";
+    }
+    cout << endl;
+
+    // columns are aligned contiguous arrays.
+    assert((size_t)table.Data<0>() % 64 == 0 && (size_t)table.Data<1>() % 64 == 0);
+    cout << "sum of column 0: " << Sum(table.Column<0>()) << ", count of column 1 > 3: " << CountIfGreater(table.Column<1>(), 3.0f) << endl;
+
+    table.Pop_Back();
+    table.Resize(5);
+    cout << "size: " << table.Size() << ", last row: " << table.Get<0>(4) << ":" << table.Get<1>(4) << ":\"" << table.Get<2>(4) << "\"" << endl;
+
+    cout << "end of test SoAVector." << endl;
+}
+
+#endif
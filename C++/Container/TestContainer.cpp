@@ -1,13 +1,1858 @@
-//**************************************************************
+﻿//**************************************************************
 //         test routines for container
 //**************************************************************
 
+#include <atomic>
+#include <cassert>
+#include <chrono>
+#include <cmath>
+#include <cstdlib>
+#include <cstring>
+#include <map>
+#include <mutex>
+#include <new>
+#include <string>
+#include <thread>
 #include "Vector.h"
 #include "List.h"
+#include "IntrusiveList.h"
+#include "UnrolledList.h"
+#include "SmallVector.h"
+#include "VectorAlgorithm.h"
+#include "FlatSet.h"
+#include "FlatMap.h"
+#include "ConcurrentVector.h"
+#include "Deque.h"
+#include "SoAVector.h"
+#include "BitVector.h"
+#include "MappedVector.h"
+#include "CowVector.h"
+#include "PersistentVector.h"
+#include "CircularBuffer.h"
+#include "..\Memory\HugePageAllocator.h"
+
+/*******************************************************/
+// count heap allocations by replacing global operator new.
+/*******************************************************/
+
+std::atomic<size_t> gAllocationCount(0); // threads of ConcurrentVector test allocate too
+std::atomic<size_t> gAllocatedBytes(0);
+
+void* operator new(size_t size)
+{
+    ++gAllocationCount;
+    gAllocatedBytes += size;
+    void* ptr = std::malloc(size == 0 ? 1 : size);
+    if (ptr == nullptr)
+        throw std::bad_alloc();
+    return ptr;
+}
+
+void* operator new(size_t size, const std::nothrow_t&) noexcept
+{
+    ++gAllocationCount;
+    gAllocatedBytes += size;
+    return std::malloc(size == 0 ? 1 : size);
+}
+
+void operator delete(void* ptr) noexcept
+{
+    std::free(ptr);
+}
+
+void operator delete(void* ptr, const std::nothrow_t&) noexcept
+{
+    std::free(ptr);
+}
+
+/*******************************************************/
+// element types counting how many times they are copied or moved.
+/*******************************************************/
+
+// only copyable, reallocation has to copy it.
+struct CopyOnlyElement
+{
+    static size_t copies;
+
+    string value;
+
+    CopyOnlyElement(const char* v) :value(v)
+    {
+    }
+
+    CopyOnlyElement(const CopyOnlyElement& other) :value(other.value)
+    {
+        ++copies;
+    }
+};
+
+size_t CopyOnlyElement::copies = 0;
+
+// move ctor will not throw, reallocation can move it.
+struct MovableElement
+{
+    static size_t copies;
+    static size_t moves;
+
+    string value;
+
+    MovableElement(const char* v) :value(v)
+    {
+    }
+
+    MovableElement(size_t count, char c) :value(count, c)
+    {
+    }
+
+    MovableElement(const MovableElement& other) :value(other.value)
+    {
+        ++copies;
+    }
+
+    MovableElement(MovableElement&& other) noexcept :value(std::move(other.value))
+    {
+        ++moves;
+    }
+
+    MovableElement& operator=(const MovableElement& other)
+    {
+        value = other.value;
+        ++copies;
+        return *this;
+    }
+
+    MovableElement& operator=(MovableElement&& other) noexcept
+    {
+        value = std::move(other.value);
+        ++moves;
+        return *this;
+    }
+};
+
+size_t MovableElement::copies = 0;
+size_t MovableElement::moves = 0;
+
+// holds resource by pointer only, safe to memcpy to new storage.
+struct RelocatableElement
+{
+    static size_t copies;
+    static size_t moves;
+
+    string* value;
+
+    RelocatableElement(const char* v) :value(new string(v))
+    {
+    }
+
+    RelocatableElement(const RelocatableElement& other) :value(new string(*other.value))
+    {
+        ++copies;
+    }
+
+    RelocatableElement(RelocatableElement&& other) noexcept :value(other.value)
+    {
+        other.value = nullptr;
+        ++moves;
+    }
+
+    ~RelocatableElement()
+    {
+        delete value;
+    }
+};
+
+size_t RelocatableElement::copies = 0;
+size_t RelocatableElement::moves = 0;
+
+template<>
+struct IsTriviallyRelocatable<RelocatableElement> : std::true_type
+{
+};
+
+// int with user provided copy, so it is not trivially copyable and shifted element by element.
+struct BoxedInt
+{
+    int value;
+
+    BoxedInt(int v) :value(v)
+    {
+    }
+
+    BoxedInt(const BoxedInt& other) :value(other.value)
+    {
+    }
+
+    BoxedInt& operator=(const BoxedInt& other)
+    {
+        value = other.value;
+        return *this;
+    }
+};
+
+// copy throws once copiesLeft runs out, move may throw, so reallocation has to copy it.
+struct ThrowingCopyElement
+{
+    static int copiesLeft;
+    static int alive;
+
+    string value;
+
+    ThrowingCopyElement(const char* v) :value(v)
+    {
+        ++alive;
+    }
+
+    ThrowingCopyElement(const ThrowingCopyElement& other) :value(other.value)
+    {
+        if (copiesLeft-- == 0)
+            throw std::runtime_error("copy failed.");
+        ++alive;
+    }
+
+    ThrowingCopyElement(ThrowingCopyElement&& other) :value(std::move(other.value))
+    {
+        ++alive;
+    }
+
+    ThrowingCopyElement& operator=(const ThrowingCopyElement& other)
+    {
+        value = other.value;
+        return *this;
+    }
+
+    ~ThrowingCopyElement()
+    {
+        --alive;
+    }
+};
+
+int ThrowingCopyElement::copiesLeft = 1000;
+int ThrowingCopyElement::alive = 0;
+
+/*******************************************************/
+// allocator counting allocations, for all instances of same T.
+/*******************************************************/
+
+template<typename T>
+class CountingAllocator : public Allocator<T>
+{
+public:
+    template<typename U>
+    struct rebind
+    {
+        typedef CountingAllocator<U> other;
+    };
+
+    T* allocate(size_t count)
+    {
+        ++allocations;
+        return Allocator<T>::allocate(count);
+    }
+
+    static size_t allocations;
+};
+
+template<typename T>
+size_t CountingAllocator<T>::allocations = 0;
+
+/*******************************************************/
+// test routines
+/*******************************************************/
+
+void ResetCounters()
+{
+    MovableElement::copies = 0;
+    MovableElement::moves = 0;
+}
+
+// emplace should construct element in-place, neither copy nor move any temporary.
+void TestEmplace()
+{
+    Vector<MovableElement> vec;
+    vec.Reserve(8);
+    ResetCounters();
+    vec.Emplace_Back("a");
+    vec.Emplace_Back(size_t(3), 'b');
+    vec.Emplace(vec.End(), "c");
+    cout << "Vector Emplace copies: " << MovableElement::copies << ", moves: " << MovableElement::moves << endl;
+    assert(MovableElement::copies == 0 && MovableElement::moves == 0);
+    assert(vec.Size() == 3 && vec[1].value == "bbb");
+
+    // push rvalue should move rather than copy.
+    ResetCounters();
+    vec.Push_Back(MovableElement("d"));
+    vec.Insert(vec.End(), MovableElement("e"));
+    cout << "Vector Push_Back/Insert rvalue copies: " << MovableElement::copies << ", moves: " << MovableElement::moves << endl;
+    assert(MovableElement::copies == 0 && MovableElement::moves == 2);
+
+    // emplace with reallocation, copying element of itself is still safe.
+    Vector<MovableElement> vec2;
+    vec2.Emplace_Back("f");
+    vec2.Emplace_Back(vec2.Front());
+    vec2.Emplace(vec2.Begin(), vec2.Back());
+    assert(vec2.Size() == 3 && vec2[0].value == "f" && vec2[2].value == "f");
+
+    List<MovableElement> lst;
+    ResetCounters();
+    lst.Emplace_Back("a");
+    lst.Emplace_Front(size_t(3), 'b');
+    lst.Emplace(++lst.Begin(), "c");
+    cout << "List Emplace copies: " << MovableElement::copies << ", moves: " << MovableElement::moves << endl;
+    assert(MovableElement::copies == 0 && MovableElement::moves == 0);
+    assert(lst.Size() == 3 && lst.Front().value == "bbb" && lst.Back().value == "a");
+
+    ResetCounters();
+    lst.Push_Back(MovableElement("d"));
+    lst.Push_Front(MovableElement("e"));
+    lst.Insert(lst.End(), MovableElement("f"));
+    cout << "List Push/Insert rvalue copies: " << MovableElement::copies << ", moves: " << MovableElement::moves << endl;
+    assert(MovableElement::copies == 0 && MovableElement::moves == 3);
+
+    cout << "end of test Emplace." << endl;
+}
+
+// reallocation which copies elements keeps the old ones if a copy throws.
+void TestVectorExceptionSafety()
+{
+    const char* names[] = { "a", "b", "c", "d" };
+    Vector<ThrowingCopyElement> vec;
+    vec.Reserve(4);
+    for (const char* name : names)
+    {
+        vec.Emplace_Back(name);
+    }
+
+    // third copy throws while relocating the elements behind pos.
+    ThrowingCopyElement::copiesLeft = 2;
+    try
+    {
+        vec.Emplace(vec.Begin() + 2, "x");
+        assert(false);
+    }
+    catch (const std::runtime_error&)
+    {
+    }
+    assert(vec.Size() == 4 && vec.Capacity() == 4 && ThrowingCopyElement::alive == 4);
+    assert(vec[0].value == "a" && vec[3].value == "d");
+
+    ThrowingCopyElement::copiesLeft = 1;
+    try
+    {
+        vec.Reserve(16);
+        assert(false);
+    }
+    catch (const std::runtime_error&)
+    {
+    }
+    assert(vec.Size() == 4 && vec.Capacity() == 4 && ThrowingCopyElement::alive == 4);
+
+    ThrowingCopyElement::copiesLeft = 3;
+    try
+    {
+        vec.Insert(vec.Begin() + 1, 2, vec[0]);
+        assert(false);
+    }
+    catch (const std::runtime_error&)
+    {
+    }
+    assert(vec.Size() == 4 && ThrowingCopyElement::alive == 4 && vec[1].value == "b");
+
+    SmallVector<ThrowingCopyElement, 4> small;
+    for (const char* name : names)
+    {
+        small.Emplace_Back(name);
+    }
+    ThrowingCopyElement::copiesLeft = 2;
+    try
+    {
+        small.Emplace(small.Begin() + 2, "x");
+        assert(false);
+    }
+    catch (const std::runtime_error&)
+    {
+    }
+    assert(small.Size() == 4 && ThrowingCopyElement::alive == 8 && small[2].value == "c");
+
+    ThrowingCopyElement::copiesLeft = 1000;
+    vec.Emplace(vec.Begin() + 2, "x");
+    assert(vec.Size() == 5 && vec[2].value == "x" && vec[4].value == "d");
+
+    cout << "end of test Vector exception safety." << endl;
+}
+
+void TestVectorPolicy()
+{
+    // stateless allocator takes no space.
+    static_assert(sizeof(Vector<int, CountingAllocator<int>>) == 3 * sizeof(int*), "allocator should not take space.");
+
+    Vector<int, CountingAllocator<int>, GrowthFactor2> vec;
+    CountingAllocator<int>::allocations = 0;
+    for (int i = 0; i < 100; i++)
+    {
+        vec.Push_Back(i);
+    }
+    // 1 2 4 8 16 32 64 128
+    cout << "2x growth allocations: " << CountingAllocator<int>::allocations << ", capacity: " << vec.Capacity() << endl;
+    assert(CountingAllocator<int>::allocations == 8 && vec.Capacity() == 128);
+
+    // capacity is the whole block malloc gave, e.g. 6 ints of the smallest glibc chunk.
+    Vector<int, Allocator<int>, GrowthSizeClass<>> vec2;
+    vec2.Push_Back(1);
+    cout << "size class growth capacity: " << vec2.Capacity() << endl;
+    assert(vec2.Capacity() >= 1 && vec2.Capacity() == vec2.GetAllocator().usable_size(vec2.Data(), 1));
+    for (int i = 0; i < 1000; i++)
+    {
+        vec2.Push_Back(i);
+    }
+    assert(vec2.Capacity() == vec2.GetAllocator().usable_size(vec2.Data(), vec2.Capacity()));
+
+    cout << "end of test Vector policy." << endl;
+}
+
+// assignment should reuse capacity, allocate only when it is not enough.
+void TestVectorAssign()
+{
+    typedef Vector<int, CountingAllocator<int>> CountingVector;
+    CountingVector large(100, 1);
+    CountingVector small(10, 2);
+    CountingVector vec;
+
+    CountingAllocator<int>::allocations = 0;
+    vec = large;
+    assert(CountingAllocator<int>::allocations == 1 && vec.Capacity() == 100);
+
+    // steady state: capacity suffices, no allocation at all.
+    CountingAllocator<int>::allocations = 0;
+    for (int i = 0; i < 1000; i++)
+    {
+        vec = small;
+        vec = large;
+        vec.Assign(50, i);
+        vec.Assign(small.Begin(), small.End());
+        vec.Assign(vec.Begin(), vec.End());
+    }
+    cout << "Vector assign allocations with enough capacity: " << CountingAllocator<int>::allocations << endl;
+    assert(CountingAllocator<int>::allocations == 0);
+    assert(vec.Size() == 10 && vec[9] == 2 && vec.Capacity() == 100);
+
+    // exact size for assign, no growth factor.
+    CountingVector vec2;
+    vec2.Assign(large.Begin(), large.End());
+    vec2.Assign(120, 3);
+    assert(vec2.Capacity() == 120);
+
+    // assign element of itself when reallocating.
+    vec2.Assign(200, vec2[0]);
+    assert(vec2.Size() == 200 && vec2[199] == 3);
+
+    // live elements are assigned, not re-constructed.
+    Vector<MovableElement> strings;
+    strings.Emplace_Back("a");
+    strings.Emplace_Back("b");
+    Vector<MovableElement> strings2;
+    strings2.Emplace_Back("c");
+    ResetCounters();
+    strings2 = strings;
+    assert(MovableElement::copies == 2 && strings2[1].value == "b");
+
+    // move assignment takes the storage together with the allocator owning it.
+    Vector<long, PoolAllocator<long>> pooled;
+    pooled.Push_Back(7);
+    {
+        Vector<long, PoolAllocator<long>> source;
+        source.Push_Back(42);
+        pooled = std::move(source);
+    }
+    pooled.Push_Back(43);
+    assert(pooled.Size() == 2 && pooled[0] == 42 && pooled[1] == 43);
+
+    CircularBuffer<long, PoolAllocator<long>> pooledRing(1);
+    {
+        CircularBuffer<long, PoolAllocator<long>> source(1);
+        source.Push_Back(42);
+        pooledRing = std::move(source);
+    }
+    assert(pooledRing.Size() == 1 && pooledRing.Front() == 42);
+
+    cout << "end of test Vector assign." << endl;
+}
+
+// large vector on huge pages, trivially relocatable elements grow by reallocate(mremap).
+void TestHugePageVector()
+{
+    Vector<int, HugePageAllocator<int>> vec;
+    for (int i = 0; i < 3000000; i++)
+    {
+        vec.Push_Back(i);
+    }
+    // append element of itself while growing.
+    vec.Reserve(vec.Size());
+    vec.Push_Back(vec[0]);
+    bool ordered = true;
+    for (int i = 0; i < 3000000; i++)
+    {
+        ordered = ordered && vec[i] == i;
+    }
+    assert(ordered && vec.Size() == 3000001 && vec[3000000] == 0);
+
+    // other elements relocate as usual.
+    Vector<MovableElement, HugePageAllocator<MovableElement>> strings;
+    for (int i = 0; i < 100000; i++)
+    {
+        strings.Emplace_Back("huge");
+    }
+    strings.Insert(strings.Begin(), strings[1]);
+    assert(strings.Size() == 100001 && strings[0].value == "huge" && strings[100000].value == "huge");
+
+    cout << "end of test huge page Vector." << endl;
+}
+
+// Sort and ParallelSort agree with std::sort for patterns pdqsort treats specially.
+void TestVectorSort()
+{
+    const int count = 200000;
+    const char* patterns[] = { "random", "sorted", "reverse", "few unique", "organ pipe" };
+    for (int pattern = 0; pattern < 5; pattern++)
+    {
+        Vector<int> vec(count, 0);
+        for (int i = 0; i < count; i++)
+        {
+            int values[] = { std::rand(), i, count - i, std::rand() % 4, i < count / 2 ? i : count - i };
+            vec[i] = values[pattern];
+        }
+        std::vector<int> expected(vec.Begin(), vec.End());
+        std::sort(expected.begin(), expected.end());
+
+        Vector<int> sorted(vec);
+        sorted.Sort();
+        Vector<int> parallel(vec);
+        parallel.ParallelSort(std::less<int>(), 4);
+        bool same = true;
+        for (int i = 0; i < count; i++)
+        {
+            same = same && sorted[i] == expected[i] && parallel[i] == expected[i];
+        }
+        cout << "sort " << patterns[pattern] << ": " << (same ? "ok" : "wrong") << endl;
+        assert(same);
+    }
+
+    // non-arithmetic elements and custom comparison take the branchy partition.
+    Vector<string> words;
+    for (int i = 0; i < 1000; i++)
+    {
+        words.Push_Back(to_string(i * 7919 % 1000));
+    }
+    words.Sort([](const string& a, const string& b) { return a.size() != b.size() ? a.size() > b.size() : a < b; });
+    assert(words.Front() == "100" && words.Back() == "9");
+    Vector<double> reals;
+    for (int i = 0; i < 100000; i++)
+    {
+        reals.Push_Back((i * 7919 % 100000) * 0.5);
+    }
+    reals.ParallelSort(std::greater<double>(), 3);
+    assert(reals.Front() == 49999.5 && reals.Back() == 0 && std::is_sorted(reals.Begin(), reals.End(), std::greater<double>()));
+
+    cout << "end of test Vector sort." << endl;
+}
+
+// RadixSort of integers, floats and records by key, compared with std::stable_sort.
+struct SortRecord
+{
+    int64_t key;
+    string payload;
+};
+
+void TestVectorRadixSort()
+{
+    const int count = 100000;
+    Vector<uint32_t> unsignedKeys;
+    Vector<int64_t> signedKeys;
+    Vector<float> floatKeys;
+    Vector<SortRecord> records;
+    for (int i = 0; i < count; i++)
+    {
+        int r = int((unsigned(std::rand()) * 32768u + unsigned(std::rand())) & 0x7fffffff);
+        unsignedKeys.Push_Back(uint32_t(r) * 2654435761u);
+        signedKeys.Push_Back(i % 3 == 0 ? -int64_t(r) * 100000 : int64_t(r) % 1000);
+        floatKeys.Push_Back(i % 2 == 0 ? -float(r) / 7 : float(r) / 3);
+        SortRecord record = { int64_t(r % 100) - 50, to_string(i) };
+        records.Push_Back(record);
+    }
+    floatKeys[0] = -0.0f;
+    floatKeys[1] = 0.0f;
+
+    std::vector<uint32_t> expectedUnsigned(unsignedKeys.Begin(), unsignedKeys.End());
+    std::sort(expectedUnsigned.begin(), expectedUnsigned.end());
+    std::vector<int64_t> expectedSigned(signedKeys.Begin(), signedKeys.End());
+    std::sort(expectedSigned.begin(), expectedSigned.end());
+    std::vector<float> expectedFloat(floatKeys.Begin(), floatKeys.End());
+    std::sort(expectedFloat.begin(), expectedFloat.end());
+    std::vector<SortRecord> expectedRecords(records.Begin(), records.End());
+    std::stable_sort(expectedRecords.begin(), expectedRecords.end(), [](const SortRecord& a, const SortRecord& b) { return a.key < b.key; });
+
+    unsignedKeys.RadixSort();
+    signedKeys.RadixSort();
+    floatKeys.RadixSort();
+    records.RadixSort([](const SortRecord& record) { return record.key; });
+
+    bool same = true;
+    for (int i = 0; i < count; i++)
+    {
+        same = same && unsignedKeys[i] == expectedUnsigned[i] && signedKeys[i] == expectedSigned[i] && floatKeys[i] == expectedFloat[i];
+        // stable: records with equal keys keep their order.
+        same = same && records[i].key == expectedRecords[i].key && records[i].payload == expectedRecords[i].payload;
+    }
+    cout << "radix sort: " << (same ? "ok" : "wrong") << ", min float " << floatKeys.Front() << ", max int64 " << signedKeys.Back() << endl;
+    assert(same);
+
+    // small vectors are insertion sorted.
+    Vector<short> small;
+    for (int i = 0; i < 10; i++)
+    {
+        small.Push_Back(short(5 - i));
+    }
+    small.RadixSort();
+    assert(small.Front() == -4 && small.Back() == 5);
+
+    // 64-bit floats are left to PdqSort, in the same order: -0.0 before 0.0.
+    Vector<double> doubleKeys;
+    for (int i = 0; i < 1000; i++)
+    {
+        doubleKeys.Push_Back(i % 2 == 0 ? -double(i) / 3 : double(i) * 7);
+    }
+    doubleKeys[0] = 0.0;
+    doubleKeys[2] = -0.0;
+    doubleKeys.RadixSort();
+    assert(doubleKeys.Front() == -998.0 / 3 && doubleKeys.Back() == 999.0 * 7);
+    assert(std::signbit(doubleKeys[498]) && !std::signbit(doubleKeys[499]) && doubleKeys[499] == 0.0);
+
+    cout << "end of test Vector radix sort." << endl;
+}
+
+/*******************************************************/
+// benchmark routines
+/*******************************************************/
+
+typedef std::chrono::high_resolution_clock BenchmarkClock;
+
+double ElapsedMilliseconds(BenchmarkClock::time_point start)
+{
+    return std::chrono::duration<double, std::milli>(BenchmarkClock::now() - start).count();
+}
+
+// push count elements and report how many copies/moves are spent on reallocation.
+// Push_Back(const T&) copies each pushed element once, which is not counted.
+template<typename T>
+void BenchmarkVectorGrowth(const char* name, size_t count, size_t& copies, size_t& moves)
+{
+    size_t oldCopies = copies;
+    size_t oldMoves = moves;
+    T element("a string long enough to defeat small string optimization");
+
+    BenchmarkClock::time_point start = BenchmarkClock::now();
+    {
+        Vector<T> vec;
+        for (size_t i = 0; i < count; ++i)
+        {
+            vec.Push_Back(element);
+        }
+    }
+    double elapsed = ElapsedMilliseconds(start);
+
+    size_t relocationCopies = copies - oldCopies - count;
+    size_t relocationMoves = moves - oldMoves;
+    cout << name << ": " << count << " Push_Back in " << elapsed << " ms, "
+        << "copies per element on reallocation: " << double(relocationCopies) / count << ", "
+        << "moves per element on reallocation: " << double(relocationMoves) / count << endl;
+}
+
+void BenchmarkVectorRelocation()
+{
+    const size_t count = 1000000;
+    size_t noMoves = 0;
+
+    // copy only: every reallocation copies all elements.
+    BenchmarkVectorGrowth<CopyOnlyElement>("copy only", count, CopyOnlyElement::copies, noMoves);
+    // nothrow movable: reallocation moves instead of copying.
+    BenchmarkVectorGrowth<MovableElement>("movable", count, MovableElement::copies, MovableElement::moves);
+    // trivially relocatable: reallocation is one memcpy, neither copy nor move.
+    BenchmarkVectorGrowth<RelocatableElement>("relocatable", count, RelocatableElement::copies, RelocatableElement::moves);
+}
+
+// build many short lived vectors of small size, which is the typical usage.
+template<typename VectorType>
+void BenchmarkSmallSize(const char* name, int size)
+{
+    const int rounds = 1000000;
+    size_t oldAllocationCount = gAllocationCount;
+    long long sum = 0;
+
+    BenchmarkClock::time_point start = BenchmarkClock::now();
+    for (int round = 0; round < rounds; ++round)
+    {
+        VectorType vec;
+        for (int i = 0; i < size; ++i)
+        {
+            vec.Push_Back(i + round);
+        }
+        sum += vec[size - 1];
+    }
+    double elapsed = ElapsedMilliseconds(start);
+
+    cout << name << " size " << size << ": " << elapsed * 1000000 / rounds << " ns per vector, "
+        << double(gAllocationCount - oldAllocationCount) / rounds << " allocations per vector"
+        << " (checksum " << sum << ")" << endl;
+}
+
+void BenchmarkSmallVector()
+{
+    for (int size = 1; size <= 16; size *= 2)
+    {
+        BenchmarkSmallSize<Vector<int>>("Vector<int>", size);
+        BenchmarkSmallSize<SmallVector<int, 8>>("SmallVector<int, 8>", size);
+    }
+}
+
+// append count ints, report reallocations and slack which malloc gave but is not used as capacity.
+template<typename Growth>
+void BenchmarkGrowth(const char* name, size_t count)
+{
+    CountingAllocator<int>::allocations = 0;
+
+    BenchmarkClock::time_point start = BenchmarkClock::now();
+    Vector<int, CountingAllocator<int>, Growth> vec;
+    for (size_t i = 0; i < count; ++i)
+    {
+        vec.Push_Back(int(i));
+    }
+    double elapsed = ElapsedMilliseconds(start);
+
+    // slack is measured by the malloc in use.
+    size_t slack = (vec.GetAllocator().usable_size(vec.Data(), vec.Capacity()) - vec.Capacity()) * sizeof(int);
+    cout << name << ": " << count << " Push_Back in " << elapsed << " ms, "
+        << CountingAllocator<int>::allocations << " allocations, "
+        << "unused size class slack " << slack << " bytes" << endl;
+}
+
+void BenchmarkGrowthPolicy()
+{
+    const size_t count = 10000000;
+    BenchmarkGrowth<GrowthFactor15>("1.5x growth", count);
+    BenchmarkGrowth<GrowthFactor2>("2x growth", count);
+    BenchmarkGrowth<GrowthSizeClass<GrowthFactor15>>("1.5x size class growth", count);
+    BenchmarkGrowth<GrowthSizeClass<GrowthFactor2>>("2x size class growth", count);
+}
+
+// read one byte per page through volatile pointer, which cannot be optimized away.
+size_t SumPages(const volatile char* data, size_t count)
+{
+    size_t sum = 0;
+    for (size_t i = 0; i < count; i += 4096)
+    {
+        sum += data[i];
+    }
+    return sum;
+}
+
+// size a buffer and then write all of it, as reading a file into it.
+// value-initialization writes zeros firstly, so each page is touched twice.
+void BenchmarkVectorResize()
+{
+    const size_t count = 256 * 1024 * 1024;
+    // write unknown value and read back some bytes, so writing buffer is not optimized away.
+    char fill = char(std::rand() | 1);
+    size_t checksum = 0;
+
+    BenchmarkClock::time_point start = BenchmarkClock::now();
+    {
+        Vector<char> buffer(count);
+        std::memset(buffer.Data(), fill, count);
+        checksum += SumPages(buffer.Data(), count);
+    }
+    cout << "value-initialized " << count << " bytes buffer: " << ElapsedMilliseconds(start) << " ms" << endl;
+
+    start = BenchmarkClock::now();
+    {
+        Vector<char> buffer(count, For_Overwrite);
+        std::memset(buffer.Data(), fill, count);
+        checksum += SumPages(buffer.Data(), count);
+    }
+    cout << "default-initialized " << count << " bytes buffer: " << ElapsedMilliseconds(start) << " ms" << endl;
+
+    start = BenchmarkClock::now();
+    {
+        Vector<char> buffer;
+        buffer.Resize_Default_Init(count);
+        std::memset(buffer.Data(), fill, count);
+        checksum += SumPages(buffer.Data(), count);
+    }
+    cout << "Resize_Default_Init " << count << " bytes buffer: " << ElapsedMilliseconds(start) << " ms" << endl;
+    cout << "checksum " << checksum << endl;
+}
+
+// insert and erase one element in the middle of vector with given size.
+template<typename T>
+void BenchmarkMiddleInsertErase(const char* name, size_t size)
+{
+    // each operation shifts half of vector, keep total bytes moved around 4GB.
+    size_t rounds = 2000000000 / (size * sizeof(T)) + 1;
+    if (rounds > 100000)
+        rounds = 100000;
+
+    Vector<T> vec(size, T(1));
+    vec.Reserve(size + 1);
+
+    BenchmarkClock::time_point start = BenchmarkClock::now();
+    for (size_t round = 0; round < rounds; ++round)
+    {
+        typename Vector<T>::iterator pos = vec.Insert(vec.Begin() + size / 2, T(int(round)));
+        vec.Erase(pos);
+    }
+    double elapsed = ElapsedMilliseconds(start);
+
+    double bytesPerRound = double(size / 2) * sizeof(T) * 2;
+    cout << name << " size " << size << ": " << elapsed * 1000000 / rounds << " ns per insert+erase, "
+        << bytesPerRound * rounds / elapsed / 1000000 << " GB/s shifted" << endl;
+}
+
+void BenchmarkVectorShift()
+{
+    for (size_t size = 1000; size <= 100000000; size *= 10)
+    {
+        BenchmarkMiddleInsertErase<int>("Vector<int>(memmove)", size);
+        // per element shift gets too slow for huge vectors.
+        if (size <= 10000000)
+        {
+            BenchmarkMiddleInsertErase<BoxedInt>("Vector<BoxedInt>(element by element)", size);
+        }
+    }
+}
+
+// run every algorithm on column buffer with each SIMD level.
+template<typename T>
+void BenchmarkVectorAlgorithmOf(const char* name)
+{
+    static const char* levelNames[] = { "scalar", "SSE4.2", "AVX2" };
+    const size_t count = 10000000;
+    const int rounds = 10;
+
+    Vector<T> vec(count, For_Overwrite);
+    for (size_t i = 0; i < count; ++i)
+    {
+        vec[i] = T(std::rand() % 1000);
+    }
+    Vector<T> filtered;
+
+    SimdLevel supported = DetectSimdLevel();
+    for (int level = SimdScalar; level <= supported; ++level)
+    {
+        SetSimdLevel(SimdLevel(level));
+        double checksum = 0;
+        double elapsed[6];
+
+        BenchmarkClock::time_point start = BenchmarkClock::now();
+        for (int round = 0; round < rounds; ++round)
+            checksum += Find(vec, T(1000)) - vec.Begin();
+        elapsed[0] = ElapsedMilliseconds(start);
+
+        start = BenchmarkClock::now();
+        for (int round = 0; round < rounds; ++round)
+            checksum += Count(vec, T(round));
+        elapsed[1] = ElapsedMilliseconds(start);
+
+        start = BenchmarkClock::now();
+        for (int round = 0; round < rounds; ++round)
+            checksum += double(Sum(vec));
+        elapsed[2] = ElapsedMilliseconds(start);
+
+        start = BenchmarkClock::now();
+        for (int round = 0; round < rounds; ++round)
+            checksum += double(MinMax(vec).second);
+        elapsed[3] = ElapsedMilliseconds(start);
+
+        start = BenchmarkClock::now();
+        for (int round = 0; round < rounds; ++round)
+            checksum += CountIfGreater(vec, T(500));
+        elapsed[4] = ElapsedMilliseconds(start);
+
+        // 1% qualified, like a selective filter on column.
+        start = BenchmarkClock::now();
+        for (int round = 0; round < rounds; ++round)
+        {
+            filtered.Clear();
+            checksum += FilterGreater(vec, T(989), filtered);
+        }
+        elapsed[5] = ElapsedMilliseconds(start);
+
+        cout << name << " " << levelNames[level] << " ms per " << count << " elements: "
+            << "Find " << elapsed[0] / rounds << ", Count " << elapsed[1] / rounds
+            << ", Sum " << elapsed[2] / rounds << ", MinMax " << elapsed[3] / rounds
+            << ", CountIfGreater " << elapsed[4] / rounds << ", FilterGreater " << elapsed[5] / rounds
+            << " (checksum " << checksum << ")" << endl;
+    }
+    SetSimdLevel(SimdAVX2);
+}
+
+void BenchmarkVectorAlgorithm()
+{
+    BenchmarkVectorAlgorithmOf<int>("Vector<int>");
+    BenchmarkVectorAlgorithmOf<float>("Vector<float>");
+    BenchmarkVectorAlgorithmOf<double>("Vector<double>");
+}
+
+// random lookups in read-mostly tables of different size.
+void BenchmarkFlatMap()
+{
+    const int lookups = 10000000;
+    for (int size = 100; size <= 1000000; size *= 100)
+    {
+        std::map<int, int> nodeMap;
+        Vector<std::pair<int, int>> items;
+        for (int i = 0; i < size; ++i)
+        {
+            int key = std::rand() * 31 + i;
+            nodeMap.insert(std::make_pair(key, i));
+            items.Push_Back(std::make_pair(key, i));
+        }
+
+        BenchmarkClock::time_point start = BenchmarkClock::now();
+        FlatMap<int, int> flatMap(items.Begin(), items.End());
+        double buildElapsed = ElapsedMilliseconds(start);
+
+        // probe existing keys in random order.
+        Vector<int> probes(lookups, For_Overwrite);
+        for (int i = 0; i < lookups; ++i)
+        {
+            probes[i] = items[std::rand() % size].first;
+        }
+
+        long long checksum = 0;
+        start = BenchmarkClock::now();
+        for (int i = 0; i < lookups; ++i)
+        {
+            checksum += nodeMap.find(probes[i])->second;
+        }
+        double mapElapsed = ElapsedMilliseconds(start);
+
+        start = BenchmarkClock::now();
+        for (int i = 0; i < lookups; ++i)
+        {
+            checksum += flatMap.Find(probes[i]).Value();
+        }
+        double flatMapElapsed = ElapsedMilliseconds(start);
+
+        cout << "table size " << size << ": std::map " << mapElapsed * 1000000 / lookups << " ns per lookup, "
+            << "FlatMap " << flatMapElapsed * 1000000 / lookups << " ns per lookup, "
+            << "FlatMap bulk build " << buildElapsed << " ms (checksum " << checksum << ")" << endl;
+    }
+}
+
+// build a vector by Push_Back, then scan it sequentially and randomly.
+// random access misses TLB on almost every access with 4KB pages, huge pages cover 512 times more memory per entry.
+template<typename Alloc>
+void BenchmarkPageScan(const char* name, size_t count)
+{
+    BenchmarkClock::time_point start = BenchmarkClock::now();
+    Vector<long long, Alloc> vec;
+    for (size_t i = 0; i < count; ++i)
+    {
+        vec.Push_Back((long long)i);
+    }
+    double buildElapsed = ElapsedMilliseconds(start);
+
+    long long sum = 0;
+    start = BenchmarkClock::now();
+    for (size_t i = 0; i < count; ++i)
+    {
+        sum += vec[i];
+    }
+    double sequentialElapsed = ElapsedMilliseconds(start);
+
+    // xorshift index generator, cheaper than the memory access itself.
+    const size_t accesses = 20000000;
+    unsigned long long state = 88172645463325252ULL;
+    start = BenchmarkClock::now();
+    for (size_t i = 0; i < accesses; ++i)
+    {
+        state ^= state << 13;
+        state ^= state >> 7;
+        state ^= state << 17;
+        sum += vec[state % count];
+    }
+    double randomElapsed = ElapsedMilliseconds(start);
+
+    cout << name << ": Push_Back " << buildElapsed << " ms, sequential scan " << sequentialElapsed << " ms, "
+        << "random access " << randomElapsed * 1000000 / accesses << " ns per access (checksum " << sum << ")" << endl;
+}
+
+void BenchmarkHugePages()
+{
+    const size_t count = 64 * 1024 * 1024; // 512MB
+    BenchmarkPageScan<Allocator<long long>>("4KB pages", count);
+    BenchmarkPageScan<HugePageAllocator<long long>>("huge pages", count);
+}
+
+// appends from 1..N threads at once, total number of elements is fixed.
+// mutex serializes all writers of Vector, ConcurrentVector writers only share one atomic counter.
+template<typename PushFunction>
+double BenchmarkParallelPush(int threads, size_t count, PushFunction push)
+{
+    BenchmarkClock::time_point start = BenchmarkClock::now();
+    std::vector<std::thread> writers;
+    for (int t = 0; t < threads; ++t)
+    {
+        writers.push_back(std::thread([t, threads, count, &push]()
+        {
+            for (size_t i = t; i < count; i += threads)
+            {
+                push(int(i));
+            }
+        }));
+    }
+    for (auto& writer : writers)
+    {
+        writer.join();
+    }
+    return ElapsedMilliseconds(start);
+}
+
+void BenchmarkConcurrentVector()
+{
+    const size_t count = 4000000;
+    int maxThreads = int(std::thread::hardware_concurrency());
+    if (maxThreads < 4)
+        maxThreads = 4;
+
+    for (int threads = 1; threads <= maxThreads; threads *= 2)
+    {
+        Vector<int> vec;
+        std::mutex lock;
+        double mutexElapsed = BenchmarkParallelPush(threads, count, [&vec, &lock](int value)
+        {
+            std::lock_guard<std::mutex> guard(lock);
+            vec.Push_Back(value);
+        });
+
+        ConcurrentVector<int> concurrentVec;
+        double concurrentElapsed = BenchmarkParallelPush(threads, count, [&concurrentVec](int value)
+        {
+            concurrentVec.Push_Back(value);
+        });
+
+        cout << threads << " threads, " << count << " Push_Back: mutex + Vector " << mutexElapsed << " ms, "
+            << "ConcurrentVector " << concurrentElapsed << " ms" << endl;
+    }
+}
+
+// queue workloads: fill and drain a large queue, and a short queue living long(producer/consumer).
+template<typename Queue>
+void BenchmarkQueue(const char* name, size_t fillCount, size_t steadyCount)
+{
+    Queue queue;
+    long long sum = 0;
+    BenchmarkClock::time_point start = BenchmarkClock::now();
+    for (size_t i = 0; i < fillCount; ++i)
+    {
+        queue.Push_Back(int(i));
+    }
+    while (!queue.Empty())
+    {
+        sum += queue.Front();
+        queue.Pop_Front();
+    }
+    double fillElapsed = ElapsedMilliseconds(start);
+
+    start = BenchmarkClock::now();
+    for (int i = 0; i < 1000; ++i)
+    {
+        queue.Push_Back(i);
+    }
+    for (size_t i = 0; i < steadyCount; ++i)
+    {
+        queue.Push_Back(int(i));
+        sum += queue.Front();
+        queue.Pop_Front();
+    }
+    double steadyElapsed = ElapsedMilliseconds(start);
+
+    cout << name << ": fill and drain " << fillCount << " in " << fillElapsed << " ms, "
+        << steadyCount << " push/pop on 1000 queued in " << steadyElapsed << " ms (checksum " << sum << ")" << endl;
+}
+
+void BenchmarkDeque()
+{
+    BenchmarkQueue<List<int>>("List", 10000000, 10000000);
+    BenchmarkQueue<Deque<int>>("Deque", 10000000, 10000000);
+}
+
+struct Particle
+{
+    float x;
+    float y;
+    float z;
+    int id;
+};
+
+// sum one field and count rows over a bound, array of structures against structure of arrays.
+void BenchmarkSoAVector()
+{
+    const size_t count = 10000000;
+    Vector<Particle> particles;
+    SoAVector<float, float, float, int> columns;
+    particles.Reserve(count);
+    columns.Reserve(count);
+    for (size_t i = 0; i < count; ++i)
+    {
+        Particle particle = { float(std::rand() % 1000), float(i % 7), float(i % 11), int(i) };
+        particles.Push_Back(particle);
+        columns.Push_Back(particle.x, particle.y, particle.z, particle.id);
+    }
+
+    const int rounds = 10;
+    double sum = 0;
+    size_t greater = 0;
+    BenchmarkClock::time_point start = BenchmarkClock::now();
+    for (int round = 0; round < rounds; ++round)
+    {
+        float roundSum = 0;
+        for (size_t i = 0; i < count; ++i)
+        {
+            roundSum += particles[i].x;
+            greater += particles[i].x > 500.0f ? 1 : 0;
+        }
+        sum += roundSum;
+    }
+    double aosElapsed = ElapsedMilliseconds(start);
+
+    start = BenchmarkClock::now();
+    for (int round = 0; round < rounds; ++round)
+    {
+        sum += Sum(columns.Column<0>());
+        greater += CountIfGreater(columns.Column<0>(), 500.0f);
+    }
+    double soaElapsed = ElapsedMilliseconds(start);
+
+    cout << "scan x of " << count << " particles: Vector<Particle> " << aosElapsed / rounds << " ms, "
+        << "SoAVector column " << soaElapsed / rounds << " ms (checksum " << sum << ", " << greater << ")" << endl;
+}
+
+// flags as bytes in Vector<bool> against bits in BitVector: memory, counting and intersecting.
+void BenchmarkBitVector()
+{
+    const size_t count = 100000000;
+    Vector<bool> byteFlags1(count), byteFlags2(count);
+    BitVector bitFlags1(count), bitFlags2(count);
+    for (size_t i = 0; i < count; ++i)
+    {
+        bool flag1 = std::rand() % 4 == 0;
+        bool flag2 = std::rand() % 2 == 0;
+        byteFlags1[i] = flag1;
+        byteFlags2[i] = flag2;
+        bitFlags1.Set(i, flag1);
+        bitFlags2.Set(i, flag2);
+    }
+
+    BenchmarkClock::time_point start = BenchmarkClock::now();
+    size_t byteCount = 0;
+    for (size_t i = 0; i < count; ++i)
+    {
+        byteFlags1[i] = byteFlags1[i] && byteFlags2[i];
+        byteCount += byteFlags1[i] ? 1 : 0;
+    }
+    double byteElapsed = ElapsedMilliseconds(start);
+
+    start = BenchmarkClock::now();
+    bitFlags1 &= bitFlags2;
+    size_t bitCount = bitFlags1.Count();
+    double bitElapsed = ElapsedMilliseconds(start);
+
+    cout << count << " flags: Vector<bool> " << byteFlags1.Capacity() / (1024 * 1024) << " MB, AND + count " << byteElapsed << " ms; "
+        << "BitVector " << bitFlags1.Capacity() / 8 / (1024 * 1024) << " MB, AND + count " << bitElapsed << " ms "
+        << "(counts " << byteCount << ", " << bitCount << ")" << endl;
+}
+
+// reload a snapshot: element by element Push_Back, ReadFrom into storage, and mapping it.
+void BenchmarkVectorSnapshot()
+{
+    const char* path = "BenchmarkVectorSnapshot.bin";
+    const size_t count = 64 * 1024 * 1024; // 512MB
+    {
+        Vector<long long> vec(count, For_Overwrite);
+        for (size_t i = 0; i < count; ++i)
+        {
+            vec[i] = (long long)i;
+        }
+        int fd = OpenVectorFileForWrite(path);
+        vec.WriteTo(fd);
+        CloseVectorFile(fd);
+    }
+
+    BenchmarkClock::time_point start = BenchmarkClock::now();
+    Vector<long long> pushed;
+    {
+        int fd = OpenVectorFileForRead(path);
+        VectorFileHeader header;
+        ReadBytes(fd, &header, sizeof(header));
+        Vector<long long> buffer(65536, For_Overwrite);
+        for (size_t left = size_t(header.count); left > 0;)
+        {
+            size_t chunk = left < buffer.Size() ? left : buffer.Size();
+            ReadBytes(fd, buffer.Data(), chunk * sizeof(long long));
+            for (size_t i = 0; i < chunk; ++i)
+            {
+                pushed.Push_Back(buffer[i]);
+            }
+            left -= chunk;
+        }
+        CloseVectorFile(fd);
+    }
+    double pushElapsed = ElapsedMilliseconds(start);
+
+    start = BenchmarkClock::now();
+    Vector<long long> loaded;
+    {
+        int fd = OpenVectorFileForRead(path);
+        loaded.ReadFrom(fd);
+        CloseVectorFile(fd);
+    }
+    double readElapsed = ElapsedMilliseconds(start);
+
+    start = BenchmarkClock::now();
+    MappedVector<long long> mapped(path);
+    double mapElapsed = ElapsedMilliseconds(start);
+
+    long long sum = 0;
+    start = BenchmarkClock::now();
+    for (long long value : mapped)
+    {
+        sum += value;
+    }
+    double scanElapsed = ElapsedMilliseconds(start);
+
+    cout << "load 512MB snapshot: Push_Back each element " << pushElapsed << " ms, ReadFrom " << readElapsed << " ms, "
+        << "MappedVector open " << mapElapsed << " ms (first scan " << scanElapsed << " ms, checksum " << sum << ")" << endl;
+
+    mapped.Close();
+    std::remove(path);
+}
+
+// hand a read-only snapshot to each request while a writer keeps updating:
+// copying a Vector per snapshot vs copying a CowVector, whose writer detaches once per snapshot.
+void BenchmarkCowVector()
+{
+    const size_t count = 1000000;
+    const int snapshots = 1000;
+    const int writesPerSnapshot = 10;
+
+    Vector<int> vec(count, 0);
+    long long sum = 0;
+    BenchmarkClock::time_point start = BenchmarkClock::now();
+    for (int s = 0; s < snapshots; ++s)
+    {
+        Vector<int> snapshot(vec);
+        sum += snapshot[s];
+        for (int w = 0; w < writesPerSnapshot; ++w)
+        {
+            vec[(s * 7919 + w) % count] = s;
+        }
+    }
+    double vectorElapsed = ElapsedMilliseconds(start);
+
+    // snapshot only, no write in between, so buffer is never copied.
+    CowVector<int> cow(count, 0);
+    start = BenchmarkClock::now();
+    for (int s = 0; s < snapshots; ++s)
+    {
+        CowVector<int> snapshot(cow);
+        sum += snapshot[s];
+    }
+    double copyElapsed = ElapsedMilliseconds(start);
+
+    // first write after each snapshot detaches, the others write in place.
+    start = BenchmarkClock::now();
+    for (int s = 0; s < snapshots; ++s)
+    {
+        CowVector<int> snapshot(cow);
+        sum += snapshot[s];
+        for (int w = 0; w < writesPerSnapshot; ++w)
+        {
+            cow.Set((s * 7919 + w) % count, s);
+        }
+    }
+    double detachElapsed = ElapsedMilliseconds(start);
+
+    cout << snapshots << " snapshots of " << count << " ints: Vector copy " << vectorElapsed << " ms; "
+        << "CowVector copy " << copyElapsed << " ms, with writes (detach) " << detachElapsed << " ms (checksum " << sum << ")" << endl;
+}
+
+// keep many versions of a large sequence, each one element different from the previous:
+// copying a Vector per version vs PersistentVector::Set sharing untouched nodes.
+void BenchmarkPersistentVector()
+{
+    const size_t count = 1000000;
+    const int versionCount = 100;
+    Vector<int> source(count, 0);
+    for (size_t i = 0; i < count; ++i)
+    {
+        source[i] = int(i);
+    }
+
+    long long sum = 0;
+    {
+        size_t oldBytes = gAllocatedBytes;
+        BenchmarkClock::time_point start = BenchmarkClock::now();
+        Vector<Vector<int>> versions;
+        versions.Reserve(versionCount);
+        versions.Push_Back(source);
+        for (int v = 1; v < versionCount; ++v)
+        {
+            versions.Push_Back(versions.Back());
+            versions.Back()[(v * 7919) % count] = -v;
+        }
+        double elapsed = ElapsedMilliseconds(start);
+        sum += versions.Back()[7919];
+        cout << versionCount << " versions of " << count << " ints: Vector copy " << elapsed / versionCount * 1000 << " us, "
+            << (gAllocatedBytes - oldBytes) / versionCount / 1024 << " KB per version" << endl;
+    }
+    {
+        PersistentVector<int> first(source);
+        size_t oldBytes = gAllocatedBytes;
+        BenchmarkClock::time_point start = BenchmarkClock::now();
+        Vector<PersistentVector<int>> versions;
+        versions.Reserve(versionCount);
+        versions.Push_Back(first);
+        for (int v = 1; v < versionCount; ++v)
+        {
+            versions.Push_Back(versions.Back().Set((v * 7919) % count, -v));
+        }
+        double elapsed = ElapsedMilliseconds(start);
+        sum += versions.Back()[7919];
+        cout << versionCount << " versions of " << count << " ints: PersistentVector::Set " << elapsed / versionCount * 1000 << " us, "
+            << (gAllocatedBytes - oldBytes) / versionCount << " bytes per version" << endl;
+    }
+
+    // building: Vector::Push_Back, a version per Push_Back, and Transient.
+    BenchmarkClock::time_point start = BenchmarkClock::now();
+    Vector<int> vec;
+    for (size_t i = 0; i < count; ++i)
+    {
+        vec.Push_Back(int(i));
+    }
+    double vectorElapsed = ElapsedMilliseconds(start);
+
+    start = BenchmarkClock::now();
+    PersistentVector<int> persistent;
+    for (size_t i = 0; i < count; ++i)
+    {
+        persistent = persistent.Push_Back(int(i));
+    }
+    double persistentElapsed = ElapsedMilliseconds(start);
+
+    start = BenchmarkClock::now();
+    PersistentVector<int>::Transient edit((PersistentVector<int>()));
+    for (size_t i = 0; i < count; ++i)
+    {
+        edit.Push_Back(int(i));
+    }
+    PersistentVector<int> built = edit.Persistent();
+    double transientElapsed = ElapsedMilliseconds(start);
+
+    // reading: sequential scan.
+    start = BenchmarkClock::now();
+    for (int value : vec)
+    {
+        sum += value;
+    }
+    double vectorScan = ElapsedMilliseconds(start);
+    start = BenchmarkClock::now();
+    for (int value : built)
+    {
+        sum += value;
+    }
+    double persistentScan = ElapsedMilliseconds(start);
+
+    cout << count << " Push_Back: Vector " << vectorElapsed << " ms, PersistentVector " << persistentElapsed << " ms, Transient "
+        << transientElapsed << " ms; scan: Vector " << vectorScan << " ms, PersistentVector " << persistentScan << " ms (checksum " << sum << ")" << endl;
+}
+
+// keep a window of the last events: Vector::Erase(Begin()) + Push_Back shifts the window per event,
+// CircularBuffer overwrites the oldest slot, one by one or in batches by Push_N.
+void BenchmarkCircularBuffer()
+{
+    const size_t window = 4096;
+    const size_t events = 1000000;
+    const size_t batch = 256;
+    Vector<int> batchValues(batch, 0);
+
+    long long sum = 0;
+    Vector<int> vec;
+    BenchmarkClock::time_point start = BenchmarkClock::now();
+    for (size_t i = 0; i < events; ++i)
+    {
+        if (vec.Size() == window)
+        {
+            vec.Erase(vec.Begin());
+        }
+        vec.Push_Back(int(i));
+    }
+    double vectorElapsed = ElapsedMilliseconds(start);
+    sum += vec.Front();
+
+    CircularBuffer<int> ring(window);
+    start = BenchmarkClock::now();
+    for (size_t i = 0; i < events; ++i)
+    {
+        ring.Push_Back(int(i));
+    }
+    double ringElapsed = ElapsedMilliseconds(start);
+    sum += ring.Front();
+
+    CircularBuffer<int> bulk(window);
+    start = BenchmarkClock::now();
+    for (size_t i = 0; i < events; i += batch)
+    {
+        for (size_t j = 0; j < batch; ++j)
+        {
+            batchValues[j] = int(i + j);
+        }
+        bulk.Push_N(batchValues.Data(), batch);
+    }
+    double bulkElapsed = ElapsedMilliseconds(start);
+    sum += bulk.Front();
+
+    cout << events << " events into window of " << window << ": Vector Erase + Push_Back " << vectorElapsed << " ms, "
+        << "CircularBuffer Push_Back " << ringElapsed << " ms, Push_N by " << batch << " " << bulkElapsed << " ms (checksum " << sum << ")" << endl;
+}
+
+// std::sort vs Vector::Sort(pdqsort) vs Vector::ParallelSort on inputs with different patterns.
+void BenchmarkVectorSort()
+{
+    const size_t count = 10000000;
+    const char* patterns[] = { "random", "sorted", "reverse", "few unique" };
+    size_t threads = std::max<unsigned>(1, std::thread::hardware_concurrency());
+    for (int pattern = 0; pattern < 4; pattern++)
+    {
+        Vector<int> input(count, For_Overwrite);
+        unsigned seed = 12345;
+        for (size_t i = 0; i < count; ++i)
+        {
+            seed = seed * 1103515245 + 12345;
+            int values[] = { int(seed >> 1), int(i), int(count - i), int(seed >> 28) };
+            input[i] = values[pattern];
+        }
+
+        std::vector<int> stdVec(input.Begin(), input.End());
+        BenchmarkClock::time_point start = BenchmarkClock::now();
+        std::sort(stdVec.begin(), stdVec.end());
+        double stdElapsed = ElapsedMilliseconds(start);
+
+        Vector<int> vec(input);
+        start = BenchmarkClock::now();
+        vec.Sort();
+        double pdqElapsed = ElapsedMilliseconds(start);
+
+        Vector<int> parallel(input);
+        start = BenchmarkClock::now();
+        parallel.ParallelSort(std::less<int>(), threads);
+        double parallelElapsed = ElapsedMilliseconds(start);
+
+        cout << "sort " << count << " " << patterns[pattern] << " ints: std::sort " << stdElapsed << " ms, Sort " << pdqElapsed
+            << " ms, ParallelSort(" << threads << " threads) " << parallelElapsed << " ms" << endl;
+    }
+}
+
+template<typename T>
+void BenchmarkRadixSortOf(const char* name, size_t count)
+{
+    Vector<T> input(count, For_Overwrite);
+    uint64_t seed = 12345;
+    for (size_t i = 0; i < count; ++i)
+    {
+        seed = seed * 6364136223846793005ULL + 1442695040888963407ULL;
+        uint64_t bits = seed ^ (seed >> 29);
+        input[i] = std::is_floating_point<T>::value ? T(int64_t(bits) >> 20) / 1024 : T(bits);
+    }
+
+    std::vector<T> stdVec(input.Begin(), input.End());
+    BenchmarkClock::time_point start = BenchmarkClock::now();
+    std::sort(stdVec.begin(), stdVec.end());
+    double stdElapsed = ElapsedMilliseconds(start);
+
+    Vector<T> vec(input);
+    start = BenchmarkClock::now();
+    vec.Sort();
+    double pdqElapsed = ElapsedMilliseconds(start);
+
+    Vector<T> radix(input);
+    start = BenchmarkClock::now();
+    radix.RadixSort();
+    double radixElapsed = ElapsedMilliseconds(start);
+
+    cout << "sort " << count << " " << name << ": std::sort " << stdElapsed << " ms, Sort " << pdqElapsed
+        << " ms, RadixSort " << radixElapsed << " ms" << endl;
+}
+
+// radix sort against comparison sorts for random keys, and records sorted by a key field.
+void BenchmarkRadixSort()
+{
+    const size_t count = 10000000;
+    BenchmarkRadixSortOf<uint32_t>("uint32_t", count);
+    BenchmarkRadixSortOf<uint64_t>("uint64_t", count);
+    BenchmarkRadixSortOf<int>("int", count);
+    BenchmarkRadixSortOf<float>("float", count);
+
+    struct KeyPayload
+    {
+        uint32_t key;
+        uint32_t payload;
+    };
+    Vector<KeyPayload> input(count, For_Overwrite);
+    for (size_t i = 0; i < count; ++i)
+    {
+        input[i].key = uint32_t(i * 2654435761u);
+        input[i].payload = uint32_t(i);
+    }
+
+    std::vector<KeyPayload> stdVec(input.Begin(), input.End());
+    BenchmarkClock::time_point start = BenchmarkClock::now();
+    std::stable_sort(stdVec.begin(), stdVec.end(), [](const KeyPayload& a, const KeyPayload& b) { return a.key < b.key; });
+    double stdElapsed = ElapsedMilliseconds(start);
+
+    Vector<KeyPayload> radix(input);
+    start = BenchmarkClock::now();
+    radix.RadixSort([](const KeyPayload& record) { return record.key; });
+    double radixElapsed = ElapsedMilliseconds(start);
+
+    cout << "sort " << count << " key/payload records: std::stable_sort " << stdElapsed << " ms, RadixSort by key " << radixElapsed << " ms" << endl;
+}
+
+struct BookOrder
+{
+    long long id;
+    int price;
+    int quantity;
+};
+
+// orders of one price level: new orders join at back, fills take from front, cancels erase
+// from the middle, and the level is cleared and refilled between sessions.
+template<typename Level>
+void BenchmarkOrderLevel(const char* name, size_t liveCount, size_t tickCount, int sessions)
+{
+    Level level;
+    long long checksum = 0;
+    size_t oldAllocationCount = gAllocationCount;
+    BenchmarkClock::time_point start = BenchmarkClock::now();
+    long long nextId = 0;
+    for (int session = 0; session < sessions; ++session)
+    {
+        for (size_t i = 0; i < liveCount; ++i)
+        {
+            BookOrder order = { nextId++, 100, int(i % 50) };
+            level.Push_Back(order);
+        }
+        for (size_t tick = 0; tick < tickCount; ++tick)
+        {
+            checksum += level.Front().quantity;
+            level.Pop_Front();
+            auto cancel = level.Begin();
+            ++cancel;
+            ++cancel;
+            level.Erase(cancel);
+            for (int i = 0; i < 2; ++i)
+            {
+                BookOrder order = { nextId++, 100, int(tick % 50) };
+                level.Push_Back(order);
+            }
+        }
+        level.Clear();
+    }
+    double elapsed = ElapsedMilliseconds(start);
+    cout << name << ": " << sessions << " sessions of " << liveCount << " orders and " << tickCount << " ticks in "
+        << elapsed << " ms, " << gAllocationCount - oldAllocationCount << " allocations (checksum " << checksum << ")" << endl;
+}
+
+void BenchmarkListPool()
+{
+    BenchmarkOrderLevel<List<BookOrder>>("List", 100000, 2000000, 5);
+    BenchmarkOrderLevel<List<BookOrder, PoolAllocator<BookOrder>>>("List with PoolAllocator", 100000, 2000000, 5);
+}
+
+// sort a list of random ints in place, against copying to a Vector, sorting it and rebuilding the list.
+void BenchmarkListSortOf(size_t count)
+{
+    List<int> sorted;
+    List<int> rebuilt;
+    for (size_t i = 0; i < count; ++i)
+    {
+        int value = int((unsigned(std::rand()) * 32768u + unsigned(std::rand())) & 0x7fffffff);
+        sorted.Push_Back(value);
+        rebuilt.Push_Back(value);
+    }
+
+    size_t oldAllocationCount = gAllocationCount;
+    BenchmarkClock::time_point start = BenchmarkClock::now();
+    sorted.Sort();
+    double sortElapsed = ElapsedMilliseconds(start);
+    size_t sortAllocations = gAllocationCount - oldAllocationCount;
+
+    oldAllocationCount = gAllocationCount;
+    start = BenchmarkClock::now();
+    Vector<int> values;
+    values.Reserve(count);
+    for (auto v : rebuilt)
+    {
+        values.Push_Back(v);
+    }
+    values.Sort();
+    rebuilt.Clear();
+    for (size_t i = 0; i < values.Size(); ++i)
+    {
+        rebuilt.Push_Back(values[i]);
+    }
+    double rebuildElapsed = ElapsedMilliseconds(start);
+    size_t rebuildAllocations = gAllocationCount - oldAllocationCount;
+
+    bool same = std::equal(sorted.Begin(), sorted.End(), rebuilt.Begin());
+    cout << "List Sort " << count << ": " << sortElapsed << " ms, " << sortAllocations << " allocations; "
+        << "copy-sort-rebuild: " << rebuildElapsed << " ms, " << rebuildAllocations << " allocations (same " << same << ")" << endl;
+}
+
+void BenchmarkListSort()
+{
+    BenchmarkListSortOf(1000000);
+    BenchmarkListSortOf(10000000);
+}
+
+struct TickState
+{
+    long long id;
+    double price;
+    double quantity;
+};
+
+// refresh a list to the latest snapshot every tick, snapshot size varies around 1000.
+template<typename State>
+void BenchmarkStateRefresh(const char* name, bool reuseNodes)
+{
+    const int snapshotCount = 8;
+    const int ticks = 20000;
+    Vector<State> snapshots;
+    for (int i = 0; i < snapshotCount; ++i)
+    {
+        State snapshot;
+        for (int j = 0; j < 1000 + (i * 7) % 20; ++j)
+        {
+            TickState state = { j, 100.0 + i, double(j % 10) };
+            snapshot.Push_Back(state);
+        }
+        snapshots.Push_Back(snapshot);
+    }
+
+    State state;
+    double checksum = 0;
+    size_t oldAllocationCount = gAllocationCount;
+    BenchmarkClock::time_point start = BenchmarkClock::now();
+    for (int tick = 0; tick < ticks; ++tick)
+    {
+        const State& snapshot = snapshots[tick % snapshotCount];
+        if (reuseNodes)
+        {
+            state = snapshot;
+        }
+        else
+        {
+            // what Assign did before: free every node and insert again.
+            state.Clear();
+            for (auto it = snapshot.Begin(); it != snapshot.End(); ++it)
+            {
+                state.Push_Back(*it);
+            }
+        }
+        checksum += state.Back().price;
+    }
+    double elapsed = ElapsedMilliseconds(start);
+    cout << name << ": " << ticks << " refreshes in " << elapsed << " ms, "
+        << gAllocationCount - oldAllocationCount << " allocations (checksum " << checksum << ")" << endl;
+}
+
+void BenchmarkListAssign()
+{
+    BenchmarkStateRefresh<List<TickState>>("List clear and insert", false);
+    BenchmarkStateRefresh<List<TickState>>("List assign", true);
+    BenchmarkStateRefresh<List<TickState, PoolAllocator<TickState>>>("List with PoolAllocator assign", true);
+}
+
+struct ArmedTimer
+{
+    long long deadline;
+    list_iterator<ArmedTimer*> position; // position in List<ArmedTimer*>
+    IntrusiveListHook hook;              // links in IntrusiveList
+};
+
+// re-arm random timers of a timer list: unlink each from where it is and append it again.
+void BenchmarkIntrusiveList()
+{
+    const size_t timerCount = 100000;
+    const size_t rearmCount = 10000000;
+    Vector<ArmedTimer> timers;
+    timers.Resize(timerCount);
+    Vector<size_t> picks;
+    picks.Reserve(rearmCount);
+    for (size_t i = 0; i < rearmCount; ++i)
+    {
+        picks.Push_Back(size_t(std::rand()) % timerCount);
+    }
+
+    List<ArmedTimer*> pointerList;
+    for (size_t i = 0; i < timerCount; ++i)
+    {
+        pointerList.Push_Back(&timers[i]);
+        timers[i].position = --pointerList.End();
+    }
+    size_t oldAllocationCount = gAllocationCount;
+    BenchmarkClock::time_point start = BenchmarkClock::now();
+    for (size_t i = 0; i < rearmCount; ++i)
+    {
+        ArmedTimer& timer = timers[picks[i]];
+        timer.deadline = (long long)i;
+        pointerList.Erase(timer.position);
+        pointerList.Push_Back(&timer);
+        timer.position = --pointerList.End();
+    }
+    double listElapsed = ElapsedMilliseconds(start);
+    size_t listAllocations = gAllocationCount - oldAllocationCount;
+    long long listChecksum = pointerList.Front()->deadline;
+
+    IntrusiveList<ArmedTimer, &ArmedTimer::hook> intrusiveList;
+    for (size_t i = 0; i < timerCount; ++i)
+    {
+        intrusiveList.Push_Back(timers[i]);
+    }
+    oldAllocationCount = gAllocationCount;
+    start = BenchmarkClock::now();
+    for (size_t i = 0; i < rearmCount; ++i)
+    {
+        ArmedTimer& timer = timers[picks[i]];
+        timer.deadline = (long long)i;
+        intrusiveList.Erase(timer);
+        intrusiveList.Push_Back(timer);
+    }
+    double intrusiveElapsed = ElapsedMilliseconds(start);
+    size_t intrusiveAllocations = gAllocationCount - oldAllocationCount;
+    long long intrusiveChecksum = intrusiveList.Front().deadline;
+    intrusiveList.Clear();
+
+    cout << "re-arm " << rearmCount << " of " << timerCount << " timers: List<T*> " << listElapsed << " ms, "
+        << listAllocations << " allocations; IntrusiveList " << intrusiveElapsed << " ms, "
+        << intrusiveAllocations << " allocations (checksum " << listChecksum << " " << intrusiveChecksum << ")" << endl;
+}
+
+template<typename Sequence>
+long long SumSequence(Sequence& sequence, int rounds)
+{
+    long long sum = 0;
+    for (int round = 0; round < rounds; ++round)
+    {
+        for (auto v : sequence)
+        {
+            sum += v;
+        }
+    }
+    return sum;
+}
+
+// iterate a sequence of ints, then insert in its middle and iterate again.
+template<typename Sequence>
+void BenchmarkSequenceScan(const char* name, size_t count, size_t insertCount)
+{
+    const int rounds = 10;
+    Sequence sequence;
+    for (size_t i = 0; i < count; ++i)
+    {
+        sequence.Push_Back(int(i & 0xff));
+    }
+
+    BenchmarkClock::time_point start = BenchmarkClock::now();
+    long long sum = SumSequence(sequence, rounds);
+    double scanElapsed = ElapsedMilliseconds(start);
+
+    auto middle = sequence.Begin();
+    for (size_t i = 0; i < count / 2; ++i)
+    {
+        ++middle;
+    }
+    start = BenchmarkClock::now();
+    for (size_t i = 0; i < insertCount; ++i)
+    {
+        // keep inserting before the same element.
+        middle = sequence.Insert(middle, int(i & 0xff));
+        ++middle;
+    }
+    double insertElapsed = ElapsedMilliseconds(start);
+
+    start = BenchmarkClock::now();
+    sum += SumSequence(sequence, rounds);
+    double rescanElapsed = ElapsedMilliseconds(start);
+
+    cout << name << ": " << rounds << " scans of " << count << " in " << scanElapsed << " ms, "
+        << insertCount << " inserts in the middle in " << insertElapsed << " ms, scans after inserts in "
+        << rescanElapsed << " ms (checksum " << sum << ")" << endl;
+}
+
+void BenchmarkUnrolledList()
+{
+    BenchmarkSequenceScan<Vector<int>>("Vector", 10000000, 100);
+    BenchmarkSequenceScan<List<int>>("List", 10000000, 1000000);
+    BenchmarkSequenceScan<UnrolledList<int>>("UnrolledList", 10000000, 1000000);
+}
 
 void main()
 {
     TestVector();
     TestList();
-}
+    TestEmplace();
+    TestVectorExceptionSafety();
+    TestSmallVector();
+    TestVectorPolicy();
+    TestVectorAssign();
+    TestVectorAlgorithm();
+    TestFlatSet();
+    TestFlatMap();
+    TestHugePageVector();
+    TestConcurrentVector();
+    TestDeque();
+    TestSoAVector();
+    TestBitVector();
+    TestMappedVector();
+    TestCowVector();
+    TestPersistentVector();
+    TestCircularBuffer();
+    TestVectorSort();
+    TestVectorRadixSort();
+    TestIntrusiveList();
+    TestUnrolledList();
 
+    BenchmarkVectorRelocation();
+    BenchmarkSmallVector();
+    BenchmarkGrowthPolicy();
+    BenchmarkVectorResize();
+    BenchmarkVectorShift();
+    BenchmarkVectorAlgorithm();
+    BenchmarkFlatMap();
+    BenchmarkHugePages();
+    BenchmarkConcurrentVector();
+    BenchmarkDeque();
+    BenchmarkSoAVector();
+    BenchmarkBitVector();
+    BenchmarkVectorSnapshot();
+    BenchmarkCowVector();
+    BenchmarkPersistentVector();
+    BenchmarkCircularBuffer();
+    BenchmarkVectorSort();
+    BenchmarkRadixSort();
+    BenchmarkListPool();
+    BenchmarkListSort();
+    BenchmarkListAssign();
+    BenchmarkIntrusiveList();
+    BenchmarkUnrolledList();
+}
@@ -0,0 +1,236 @@
+//**************************************************************
+//         uninitialized storage algorithms shared by containers
+//**************************************************************
+
+#ifndef UNINITIALIZED_H
+#define UNINITIALIZED_H
+
+#include <cstring>
+#include <iterator>
+#include <memory>
+#include <type_traits>
+#include <utility>
+
+// relocation = move-construct objects into new storage + destroy the old ones.
+// containers relocate all their elements on every reallocation, doing it by copy
+// (std::uninitialized_copy + destroy) deep-copies every element, e.g. every string buffer.
+
+// T is trivially relocatable if copying its bytes to new storage and forgetting the old
+// storage(without calling dtor) gives a valid object. trivially copyable types are always
+// trivially relocatable, other types(e.g. a type only holding a unique_ptr) can opt in by
+// specializing this trait to true_type.
+template<typename T>
+struct IsTriviallyRelocatable : std::is_trivially_copyable<T>
+{
+};
+
+// tags to dispatch relocation strategy.
+struct RelocateByMemcpyTag {};
+struct RelocateByMoveTag {};
+struct RelocateByCopyTag {};
+
+// pick cheapest relocation strategy which is still safe:
+// 1. memcpy for trivially relocatable types.
+// 2. move for types whose move ctor will not throw, so the source range is never left half moved.
+// 3. copy otherwise, source range is untouched if one copy throws(strong guarantee as std::vector).
+template<typename T>
+struct RelocateCategory
+{
+    typedef typename std::conditional<IsTriviallyRelocatable<T>::value,
+        RelocateByMemcpyTag,
+        typename std::conditional<std::is_nothrow_move_constructible<T>::value || !std::is_copy_constructible<T>::value,
+            RelocateByMoveTag,
+            RelocateByCopyTag>::type>::type type;
+};
+
+// destroy(deconstruct) objects in range [first, last).
+template<typename T>
+void DestroyRange(T* first, T* last)
+{
+    for (; first != last; ++first)
+    {
+        first->~T();
+    }
+}
+
+// relocation in two steps: construct objects of [first, last) in dest, then destroy the source.
+// if constructing throws, objects constructed in dest are destroyed and the source is untouched(copy),
+// so a container can drop new storage and keep its elements.
+template<typename T>
+T* UninitializedRelocateConstruct(T* first, T* last, T* dest, RelocateByMemcpyTag)
+{
+    size_t count = last - first;
+    // note first could be nullptr for empty container, memcpy with nullptr is undefined even if count is 0.
+    if (count > 0)
+    {
+        std::memcpy(static_cast<void*>(dest), static_cast<const void*>(first), count * sizeof(T));
+    }
+    return dest + count;
+}
+
+template<typename T>
+T* UninitializedRelocateConstruct(T* first, T* last, T* dest, RelocateByMoveTag)
+{
+    T* current = dest;
+    try
+    {
+        for (T* source = first; source != last; ++source, ++current)
+        {
+            ::new(static_cast<void*>(current)) T(std::move(*source));
+        }
+    }
+    catch (...)
+    {
+        DestroyRange(dest, current);
+        throw;
+    }
+    return current;
+}
+
+template<typename T>
+T* UninitializedRelocateConstruct(T* first, T* last, T* dest, RelocateByCopyTag)
+{
+    return std::uninitialized_copy(first, last, dest);
+}
+
+// bytes were copied, source is forgotten without dtor.
+template<typename T>
+void DestroyRelocated(T*, T*, RelocateByMemcpyTag)
+{
+}
+
+template<typename T>
+void DestroyRelocated(T* first, T* last, RelocateByMoveTag)
+{
+    DestroyRange(first, last);
+}
+
+template<typename T>
+void DestroyRelocated(T* first, T* last, RelocateByCopyTag)
+{
+    DestroyRange(first, last);
+}
+
+template<typename T, typename Tag>
+T* UninitializedRelocate(T* first, T* last, T* dest, Tag tag)
+{
+    T* newLast = UninitializedRelocateConstruct(first, last, dest, tag);
+    DestroyRelocated(first, last, tag);
+    return newLast;
+}
+
+template<typename T>
+T* UninitializedMove(T* first, T* last, T* dest, std::true_type)
+{
+    size_t count = last - first;
+    if (count > 0)
+    {
+        std::memcpy(static_cast<void*>(dest), static_cast<const void*>(first), count * sizeof(T));
+    }
+    return dest + count;
+}
+
+template<typename T>
+T* UninitializedMove(T* first, T* last, T* dest, std::false_type)
+{
+    return std::uninitialized_copy(std::make_move_iterator(first), std::make_move_iterator(last), dest);
+}
+
+// move construct objects in [first, last) to uninitialized storage starting from dest, which must not overlap.
+// unlike relocation, objects in [first, last) are left alive in moved-from state.
+template<typename T>
+T* UninitializedMove(T* first, T* last, T* dest)
+{
+    return UninitializedMove(first, last, dest, std::is_trivially_copyable<T>());
+}
+
+// value-initialize objects in [first, last) as T(), which zeros trivial types.
+template<typename T>
+T* UninitializedValueConstruct(T* first, T* last)
+{
+    T* current = first;
+    try
+    {
+        for (; current != last; ++current)
+        {
+            ::new(static_cast<void*>(current)) T();
+        }
+    }
+    catch (...)
+    {
+        DestroyRange(first, current);
+        throw;
+    }
+    return current;
+}
+
+template<typename T>
+T* UninitializedDefaultConstruct(T*, T* last, std::true_type)
+{
+    // default-initialization of trivial type does nothing, so do not touch memory at all.
+    return last;
+}
+
+template<typename T>
+T* UninitializedDefaultConstruct(T* first, T* last, std::false_type)
+{
+    T* current = first;
+    try
+    {
+        for (; current != last; ++current)
+        {
+            ::new(static_cast<void*>(current)) T;
+        }
+    }
+    catch (...)
+    {
+        DestroyRange(first, current);
+        throw;
+    }
+    return current;
+}
+
+// default-initialize objects in [first, last) as "new T" without parentheses,
+// which leaves trivial types uninitialized(indeterminate value) instead of zeroing them.
+// it is used when objects will be overwritten immediately, e.g. buffer to read into.
+template<typename T>
+T* UninitializedDefaultConstruct(T* first, T* last)
+{
+    return UninitializedDefaultConstruct(first, last, std::is_trivially_default_constructible<T>());
+}
+
+// relocate [first, pos) to dest and [pos, last) behind gap objects already constructed at dest + (pos - first),
+// as reallocation for insert does. old objects are destroyed only after all of them are in dest,
+// if one copy throws, the objects constructed in dest(including the gap) are destroyed and [first, last)
+// is untouched, caller only deallocates dest. return the end of relocated objects in dest.
+template<typename T>
+T* UninitializedRelocateAround(T* first, T* pos, T* last, T* dest, size_t gap)
+{
+    typedef typename RelocateCategory<T>::type Category;
+    T* gapFirst = dest + (pos - first);
+    T* newLast = dest;
+    try
+    {
+        newLast = UninitializedRelocateConstruct(first, pos, dest, Category());
+        newLast = UninitializedRelocateConstruct(pos, last, gapFirst + gap, Category());
+    }
+    catch (...)
+    {
+        DestroyRange(dest, newLast);
+        DestroyRange(gapFirst, gapFirst + gap);
+        throw;
+    }
+    DestroyRelocated(first, last, Category());
+    return newLast;
+}
+
+// relocate objects in [first, last) to uninitialized storage starting from dest.
+// after relocation [first, last) is raw storage and should not be destroyed again.
+// return the end of relocated objects in dest.
+template<typename T>
+T* UninitializedRelocate(T* first, T* last, T* dest)
+{
+    return UninitializedRelocate(first, last, dest, typename RelocateCategory<T>::type());
+}
+
+#endif
@@ -0,0 +1,899 @@
+//**************************************************************
+//         unrolled linked list, nodes hold arrays of elements
+//**************************************************************
+
+#ifndef UNROLLEDLIST_H
+#define UNROLLEDLIST_H
+
+#include <algorithm>
+#include <cassert>
+#include <cstddef>
+#include <iostream>
+#include <iterator>
+#include <memory>
+#include <new>
+#include <stdexcept>
+#include <string>
+#include <type_traits>
+#include <utility>
+#include "..\Memory\Allocator.h"
+#include "List.h"
+
+using namespace std;
+
+// each Node<T> of List holds one value between two pointers, List<int> pays 16 bytes of links for
+// 4 bytes of value and a cache miss for every element it iterates.
+// UnrolledList links nodes the same way, but a node keeps an array of elements:
+//
+//   head <-> [xxxxxxx...] <-> [xxxx......] <-> [xxxxxxxxxx] <-> head     x: element, .: raw slot
+//
+// elements of a node are contiguous, so iteration walks an array and only jumps between nodes.
+// inserting in the middle shifts at most one node's elements, a full node is split into two halves,
+// and a node getting less than half full on erase is merged with a neighbour when they fit in one,
+// so nodes stay more than half full on average.
+// the sentinel is a full node without elements, kept inside the list.
+//
+// insert and erase invalidate iterators and references to elements of the nodes they touch.
+// nodes are spliced between lists whose allocators compare equal, otherwise(e.g. lists with their own
+// PoolAllocator) Splice moves the elements one by one as List does.
+
+// number of elements per node: a node of 2 cache lines(128 bytes) including links and count,
+// but at least 4 elements for large types.
+template<typename T>
+struct UnrolledNodeCapacity
+{
+    static const size_t available = 128 - sizeof(ListLinks) - sizeof(size_t);
+    static const size_t value = (available / sizeof(T) > 4) ? available / sizeof(T) : 4;
+};
+
+template<typename T, size_t Capacity>
+struct UnrolledNode : ListLinks
+{
+    size_t count;
+    typename std::aligned_storage<sizeof(T) * Capacity, std::alignment_of<T>::value>::type storage;
+
+    T* Values()
+    {
+        return reinterpret_cast<T*>(&storage);
+    }
+};
+
+// iterator walks the array of a node by pointer and jumps to the next node at its end.
+// end() points to the sentinel node, which has no elements.
+template<typename T, size_t Capacity>
+class unrolled_list_iterator
+{
+    typedef UnrolledNode<T, Capacity> NodeType;
+public:
+    typedef std::bidirectional_iterator_tag iterator_category;
+    typedef T value_type;
+    typedef ptrdiff_t difference_type;
+    typedef T* pointer;
+    typedef T& reference;
+
+    unrolled_list_iterator() :cur(nullptr), last(nullptr), node(nullptr)
+    {
+    }
+
+    unrolled_list_iterator(NodeType* n, size_t index) :cur(n->Values() + index), last(n->Values() + n->count), node(n)
+    {
+    }
+
+    bool operator==(const unrolled_list_iterator& other) const
+    {
+        return cur == other.cur;
+    }
+
+    bool operator!=(const unrolled_list_iterator& other) const
+    {
+        return cur != other.cur;
+    }
+
+    reference operator*() const
+    {
+        return *cur;
+    }
+
+    pointer operator->() const
+    {
+        return cur;
+    }
+
+    // pre-increment
+    unrolled_list_iterator& operator++()
+    {
+        if (++cur == last)
+        {
+            node = static_cast<NodeType*>(node->next);
+            cur = node->Values();
+            last = cur + node->count;
+        }
+        return *this;
+    }
+
+    // post-increment
+    unrolled_list_iterator operator++(int)
+    {
+        unrolled_list_iterator temp = *this;
+        ++(*this);
+        return temp;
+    }
+
+    // pre-decrement
+    unrolled_list_iterator& operator--()
+    {
+        if (cur == node->Values())
+        {
+            node = static_cast<NodeType*>(node->prev);
+            last = node->Values() + node->count;
+            cur = last;
+        }
+        --cur;
+        return *this;
+    }
+
+    // post-decrement
+    unrolled_list_iterator operator--(int)
+    {
+        unrolled_list_iterator temp = *this;
+        --(*this);
+        return temp;
+    }
+
+    // index of element in its node.
+    size_t Index() const
+    {
+        return cur - node->Values();
+    }
+
+public:
+    T* cur;         // current element
+    T* last;        // end of elements of node
+    NodeType* node;
+};
+
+template<typename T, typename Alloc = Allocator<T>>
+class UnrolledList : private Alloc::template rebind<UnrolledNode<T, UnrolledNodeCapacity<T>::value>>::other
+{
+public:
+    static const size_t NodeCapacity = UnrolledNodeCapacity<T>::value;
+
+private:
+    typedef UnrolledNode<T, NodeCapacity> NodeType;
+    typedef typename Alloc::template rebind<NodeType>::other NodeAlloc;
+
+    // element as node and index in node, kept across splits.
+    struct Position
+    {
+        NodeType* node;
+        size_t index;
+    };
+
+public:
+    typedef T value_type;
+    typedef T& reference;
+    typedef const T& const_reference;
+    typedef unrolled_list_iterator<T, NodeCapacity> iterator;
+
+    /*******************************************************/
+    // ctor and dtor
+    /*******************************************************/
+    UnrolledList()
+    {
+        InitializeList();
+    }
+
+    UnrolledList(const UnrolledList& other)
+        :NodeAlloc(other.GetAlloc())
+    {
+        InitializeList();
+        try
+        {
+            for (iterator it = other.Begin(); it != other.End(); ++it)
+            {
+                Push_Back(*it);
+            }
+        }
+        catch (...)
+        {
+            Clear();
+            throw;
+        }
+    }
+
+    // nodes stay in place with the allocator that owns them.
+    UnrolledList(UnrolledList&& other)
+        :NodeAlloc(std::move(other.GetAlloc()))
+    {
+        InitializeList();
+        TakeNodes(other);
+    }
+
+    ~UnrolledList()
+    {
+        Clear();
+    }
+
+    UnrolledList& operator=(const UnrolledList& other)
+    {
+        if (this != &other)
+        {
+            Clear();
+            for (iterator it = other.Begin(); it != other.End(); ++it)
+            {
+                Push_Back(*it);
+            }
+        }
+        return *this;
+    }
+
+    UnrolledList& operator=(UnrolledList&& other)
+    {
+        if (this != &other)
+        {
+            Clear();
+            GetAlloc() = std::move(other.GetAlloc());
+            TakeNodes(other);
+        }
+        return *this;
+    }
+
+    /*******************************************************/
+    // Capacity
+    /*******************************************************/
+    bool Empty() const
+    {
+        return size == 0;
+    }
+
+    // Returns the number of elements in the container
+    size_t Size() const
+    {
+        return size;
+    }
+
+    /*******************************************************/
+    // Modifiers
+    /*******************************************************/
+
+    // Removes all elements from the container.
+    void Clear()
+    {
+        NodeType* node = static_cast<NodeType*>(head.next);
+        while (node != &head)
+        {
+            NodeType* next = static_cast<NodeType*>(node->next);
+            DestroyValues(node->Values(), node->Values() + node->count);
+            GetAlloc().deallocate(node, 1);
+            node = next;
+        }
+        InitializeList();
+    }
+
+    // inserts value before pos.
+    iterator Insert(iterator pos, const T& value)
+    {
+        return Emplace(pos, value);
+    }
+
+    iterator Insert(iterator pos, T&& value)
+    {
+        return Emplace(pos, std::move(value));
+    }
+
+    // constructs element before pos.
+    // Returns iterator pointing to the emplaced element.
+    template<class... Args>
+    iterator Emplace(iterator pos, Args&&... args)
+    {
+        // args may refer to an element which is moved below.
+        T value(std::forward<Args>(args)...);
+
+        NodeType* node = pos.node;
+        size_t index = pos.Index();
+        if (node == &head)
+        {
+            // at end: append to the last node, or start a new one when it is full.
+            node = static_cast<NodeType*>(head.prev);
+            index = node->count;
+            if (node == &head || node->count == NodeCapacity)
+            {
+                node = NewNodeAfter(node);
+                index = 0;
+            }
+        }
+        else if (index == 0 && node->prev != &head && static_cast<NodeType*>(node->prev)->count < NodeCapacity)
+        {
+            // at start of a node: append to the previous node if it has room.
+            node = static_cast<NodeType*>(node->prev);
+            index = node->count;
+        }
+        else if (node->count == NodeCapacity)
+        {
+            if (index == 0)
+            {
+                node = NewNodeAfter(static_cast<NodeType*>(node->prev));
+            }
+            else
+            {
+                // split full node into two halves, insert into the half holding pos.
+                size_t half = NodeCapacity / 2;
+                NodeType* upper = MoveTail(node, half);
+                if (index > half)
+                {
+                    node = upper;
+                    index -= half;
+                }
+            }
+        }
+
+        try
+        {
+            InsertInNode(node, index, std::move(value));
+        }
+        catch (...)
+        {
+            // iterators must never step into an empty node, free the one made for value.
+            if (node->count == 0)
+            {
+                FreeNode(node);
+            }
+            throw;
+        }
+        ++size;
+        return iterator(node, index);
+    }
+
+    // Removes the element at pos.
+    // Returns iterator following the removed element.
+    iterator Erase(iterator pos)
+    {
+        NodeType* node = pos.node;
+        size_t index = pos.Index();
+        T* values = node->Values();
+        std::move(values + index + 1, values + node->count, values + index);
+        --node->count;
+        values[node->count].~T();
+        --size;
+
+        if (node->count == 0)
+        {
+            NodeType* next = static_cast<NodeType*>(node->next);
+            FreeNode(node);
+            return iterator(next, 0);
+        }
+
+        if (node->count < NodeCapacity / 2 && !MergeNext(node))
+        {
+            // merge into previous node, element following pos moves there too.
+            NodeType* prev = static_cast<NodeType*>(node->prev);
+            size_t prevCount = prev->count;
+            if (MergeNext(prev))
+            {
+                node = prev;
+                index += prevCount;
+            }
+        }
+        return MakeIterator(node, index);
+    }
+
+    // Removes the elements in the range[first; last).
+    // Return iterator following the last removed element.
+    iterator Erase(iterator first, iterator last)
+    {
+        if (first == Begin() && last == End())
+        {
+            Clear();
+            return End();
+        }
+
+        // count first, erase may merge nodes and move the element last points to.
+        size_t count = 0;
+        for (iterator it = first; it != last; ++it)
+        {
+            ++count;
+        }
+        for (; count > 0; --count)
+        {
+            first = Erase(first);
+        }
+        return first;
+    }
+
+    void Push_Back(const T& value)
+    {
+        Emplace(End(), value);
+    }
+
+    void Push_Back(T&& value)
+    {
+        Emplace(End(), std::move(value));
+    }
+
+    void Pop_Back()
+    {
+        Erase(--End());
+    }
+
+    void Push_Front(const T& value)
+    {
+        Emplace(Begin(), value);
+    }
+
+    void Push_Front(T&& value)
+    {
+        Emplace(Begin(), std::move(value));
+    }
+
+    void Pop_Front()
+    {
+        Erase(Begin());
+    }
+
+    // constructs an element in-place at the end.
+    // Returns a reference to the inserted element.
+    template<class... Args>
+    reference Emplace_Back(Args&&... args)
+    {
+        return *Emplace(End(), std::forward<Args>(args)...);
+    }
+
+    /*******************************************************/
+    // Iterators
+    /*******************************************************/
+
+    // specially for "Range for". Need begin(),end().
+    iterator begin()
+    {
+        return Begin();
+    }
+
+    iterator end()
+    {
+        return End();
+    }
+
+    iterator Begin()
+    {
+        return iterator(static_cast<NodeType*>(head.next), 0);
+    }
+
+    iterator Begin() const
+    {
+        return iterator(static_cast<NodeType*>(head.next), 0);
+    }
+
+    iterator End()
+    {
+        return iterator(&head, 0);
+    }
+
+    iterator End() const
+    {
+        return iterator(const_cast<NodeType*>(&head), 0);
+    }
+
+    /*******************************************************/
+    // Accessor
+    /*******************************************************/
+
+    // Calling front on an empty container is undefined.
+    reference Front()
+    {
+        return *Begin();
+    }
+
+    // Calling back on an empty container is undefined.
+    reference Back()
+    {
+        return *(--End());
+    }
+
+    /*******************************************************/
+    // Operations
+    /*******************************************************/
+
+    // transfer all elements from another list into *this before pos.
+    // nodes of other are relinked if allocators compare equal, no element is copied.
+    void Splice(iterator pos, UnrolledList& other)
+    {
+        if (this != &other)
+        {
+            Splice(pos, other, other.Begin(), other.End());
+        }
+    }
+
+    // Transfers the element pointed to by it from other into *this before pos.
+    void Splice(iterator pos, UnrolledList& other, iterator it)
+    {
+        iterator last = it;
+        ++last;
+        if (pos != it && pos != last)
+        {
+            Splice(pos, other, it, last);
+        }
+    }
+
+    // Transfers the elements in the range [first, last) from other into *this before pos.
+    // nodes are split at pos, first and last, so the range is whole nodes, which are relinked.
+    // only elements sharing a node with pos, first or last are moved. pos must not be in [first, last).
+    // if allocators differ, nodes can not change owner, all elements are moved into nodes of this list.
+    void Splice(iterator pos, UnrolledList& other, iterator first, iterator last)
+    {
+        if (first == last)
+            return;
+
+        if (this != &other && GetAlloc() != other.GetAlloc())
+        {
+            MoveElements(pos, other, first, last);
+            return;
+        }
+
+        Position to = { pos.node, pos.Index() };
+        Position from = { first.node, first.Index() };
+        Position until = { last.node, last.Index() };
+        SplitBefore(to, from, until);
+        other.SplitBefore(until, to, from);
+        other.SplitBefore(from, to, until);
+
+        NodeType* sourcePrev = static_cast<NodeType*>(from.node->prev);
+        NodeType* lastNode = static_cast<NodeType*>(until.node->prev);
+        size_t count = 0;
+        for (ListLinks* node = from.node; node != until.node; node = node->next)
+        {
+            count += static_cast<NodeType*>(node)->count;
+        }
+        ListTransfer(to.node, from.node, until.node);
+
+        if (this != &other)
+        {
+            other.size -= count;
+            size += count;
+
+            // nodes split at the seams are merged back when they fit in one.
+            other.MergeNext(sourcePrev);
+            MergeNext(lastNode);
+            MergeNext(static_cast<NodeType*>(from.node->prev));
+        }
+    }
+
+private:
+    NodeAlloc& GetAlloc()
+    {
+        return *this;
+    }
+
+    // moves elements [first, last) of other before pos and erases them from other.
+    // insert and erase invalidate iterators of the nodes they touch, so the elements are counted first.
+    void MoveElements(iterator pos, UnrolledList& other, iterator first, iterator last)
+    {
+        size_t count = std::distance(first, last);
+        for (size_t i = 0; i < count; ++i)
+        {
+            pos = Emplace(pos, std::move(*first));
+            ++pos;
+            first = other.Erase(first);
+        }
+    }
+
+    const NodeAlloc& GetAlloc() const
+    {
+        return *this;
+    }
+
+    void InitializeList()
+    {
+        head.next = &head;
+        head.prev = &head;
+        head.count = 0;
+        size = 0;
+    }
+
+    // take all nodes of other, which must be allocated by allocator of this list. this list is empty.
+    void TakeNodes(UnrolledList& other)
+    {
+        if (!other.Empty())
+        {
+            head.next = other.head.next;
+            head.prev = other.head.prev;
+            head.next->prev = &head;
+            head.prev->next = &head;
+            size = other.size;
+            other.InitializeList();
+        }
+    }
+
+    // iterator to element index of node, index may be the count of node for the start of next node.
+    iterator MakeIterator(NodeType* node, size_t index)
+    {
+        if (index == node->count)
+            return iterator(static_cast<NodeType*>(node->next), 0);
+        return iterator(node, index);
+    }
+
+    static void DestroyValues(T* first, T* last)
+    {
+        for (; first != last; ++first)
+        {
+            first->~T();
+        }
+    }
+
+    // allocate an empty node and link it after node.
+    NodeType* NewNodeAfter(NodeType* node)
+    {
+        NodeType* newNode = GetAlloc().allocate(1);
+        newNode->count = 0;
+        ListLinks* next = node->next;
+        newNode->prev = node;
+        newNode->next = next;
+        next->prev = newNode;
+        node->next = newNode;
+        return newNode;
+    }
+
+    // unlink and free an empty node.
+    void FreeNode(NodeType* node)
+    {
+        node->prev->next = node->next;
+        node->next->prev = node->prev;
+        GetAlloc().deallocate(node, 1);
+    }
+
+    // move elements [index, count) of node into a new node after it. Returns the new node.
+    NodeType* MoveTail(NodeType* node, size_t index)
+    {
+        NodeType* upper = NewNodeAfter(node);
+        T* values = node->Values();
+        size_t count = node->count;
+        try
+        {
+            std::uninitialized_copy(std::make_move_iterator(values + index), std::make_move_iterator(values + count), upper->Values());
+        }
+        catch (...)
+        {
+            FreeNode(upper);
+            throw;
+        }
+        DestroyValues(values + index, values + count);
+        node->count = index;
+        upper->count = count - index;
+        return upper;
+    }
+
+    // moves elements of next node to the end of node and frees next, if they fit in one node.
+    // Returns true if merged.
+    bool MergeNext(NodeType* node)
+    {
+        NodeType* next = static_cast<NodeType*>(node->next);
+        if (node == &head || next == &head || node->count + next->count > NodeCapacity)
+            return false;
+
+        T* values = next->Values();
+        std::uninitialized_copy(std::make_move_iterator(values), std::make_move_iterator(values + next->count), node->Values() + node->count);
+        DestroyValues(values, values + next->count);
+        node->count += next->count;
+        next->count = 0;
+        FreeNode(next);
+        return true;
+    }
+
+    // insert value at index of node, which has room for it.
+    void InsertInNode(NodeType* node, size_t index, T&& value)
+    {
+        T* values = node->Values();
+        size_t count = node->count;
+        if (index == count)
+        {
+            ::new((void*)(values + count)) T(std::move(value));
+        }
+        else
+        {
+            ::new((void*)(values + count)) T(std::move(values[count - 1]));
+            std::move_backward(values + index, values + count - 1, values + count);
+            values[index] = std::move(value);
+        }
+        ++node->count;
+    }
+
+    // makes p the first element of its node by moving the elements from p on into a new node.
+    // positions a and b at or behind p in the same node move along with their elements.
+    void SplitBefore(Position& p, Position& a, Position& b)
+    {
+        if (p.index == 0)
+            return;
+
+        NodeType* node = p.node;
+        size_t index = p.index;
+        NodeType* upper = MoveTail(node, index);
+        Position* positions[] = { &a, &b };
+        for (Position* q : positions)
+        {
+            if (q->node == node && q->index >= index)
+            {
+                q->node = upper;
+                q->index -= index;
+            }
+        }
+        p.node = upper;
+        p.index = 0;
+    }
+
+private:
+    NodeType head;// sentinel node without elements
+    size_t size;  // number of elements
+};
+
+// element whose move throws while failMove is set.
+struct UnrolledFailingMove
+{
+    explicit UnrolledFailingMove(int v) :value(v)
+    {
+    }
+
+    UnrolledFailingMove(const UnrolledFailingMove& other) :value(other.value)
+    {
+    }
+
+    UnrolledFailingMove(UnrolledFailingMove&& other) :value(other.value)
+    {
+        if (failMove)
+            throw std::runtime_error("Error: move of element failed.");
+    }
+
+    UnrolledFailingMove& operator=(const UnrolledFailingMove& other)
+    {
+        value = other.value;
+        return *this;
+    }
+
+    int value;
+    static bool failMove;
+};
+
+bool UnrolledFailingMove::failMove = false;
+
+// test routines for unrolled list
+void TestUnrolledList()
+{
+    const size_t capacity = UnrolledList<int>::NodeCapacity;
+    cout << "UnrolledList<int> node capacity: " << capacity << endl;
+
+    UnrolledList<int> lst;
+    List<int> expected;
+    for (int i = 0; i < 200; i++)
+    {
+        lst.Push_Back(i);
+        expected.Push_Back(i);
+    }
+    for (int i = 0; i < 10; i++)
+    {
+        lst.Push_Front(-i);
+        expected.Push_Front(-i);
+    }
+
+    // insert into full nodes splits them, erase merges them again.
+    auto it = lst.Begin();
+    auto expectedIt = expected.Begin();
+    for (int i = 0; i < 150; i++)
+    {
+        if (i % 3 == 2)
+        {
+            it = lst.Erase(it);
+            expectedIt = expected.Erase(expectedIt);
+        }
+        else
+        {
+            it = lst.Insert(it, 1000 + i);
+            expectedIt = expected.Insert(expectedIt, 1000 + i);
+            ++it;
+            ++expectedIt;
+            ++it;
+            ++expectedIt;
+        }
+    }
+    assert(lst.Size() == expected.Size() && std::equal(expected.Begin(), expected.End(), lst.Begin()));
+
+    // walk backwards.
+    size_t backward = 0;
+    for (auto back = lst.End(); back != lst.Begin(); --back)
+    {
+        ++backward;
+    }
+    assert(backward == lst.Size());
+
+    lst.Erase(++lst.Begin(), --lst.End());
+    assert(lst.Size() == 2 && lst.Front() == expected.Front() && lst.Back() == 199);
+
+    // splice whole list, a range and one element.
+    UnrolledList<string> words;
+    UnrolledList<string> more;
+    for (int i = 0; i < 100; i++)
+    {
+        words.Push_Back("w" + to_string(i));
+        more.Push_Back("m" + to_string(i));
+    }
+    auto middle = words.Begin();
+    for (int i = 0; i < 50; i++)
+    {
+        ++middle;
+    }
+    auto first = more.Begin();
+    ++first;
+    auto last = first;
+    for (int i = 0; i < 40; i++)
+    {
+        ++last;
+    }
+    words.Splice(middle, more, first, last);
+    assert(words.Size() == 140 && more.Size() == 60);
+    auto check = words.Begin();
+    for (int i = 0; i < 50; i++)
+    {
+        ++check;
+    }
+    assert(*check == "m1" && *--check == "w49");
+
+    words.Splice(words.Begin(), more, --more.End());
+    assert(words.Front() == "m99" && more.Back() == "m98" && words.Size() == 141);
+
+    words.Splice(words.End(), more);
+    assert(more.Empty() && words.Size() == 200 && words.Back() == "m98");
+
+    UnrolledList<string> copy(words);
+    UnrolledList<string> moved(std::move(words));
+    assert(words.Empty() && moved.Size() == 200 && std::equal(moved.Begin(), moved.End(), copy.Begin()));
+    PrintList(more);
+
+    // lists with their own pools move elements on Splice, nodes stay with their pool.
+    UnrolledList<string, PoolAllocator<string>> pooled;
+    UnrolledList<string, PoolAllocator<string>> source;
+    for (int i = 0; i < 100; i++)
+    {
+        pooled.Push_Back("p" + to_string(i));
+        source.Push_Back("s" + to_string(i));
+    }
+    auto sourceFirst = source.Begin();
+    ++sourceFirst;
+    auto sourceLast = sourceFirst;
+    for (int i = 0; i < 30; i++)
+    {
+        ++sourceLast;
+    }
+    pooled.Splice(++pooled.Begin(), source, sourceFirst, sourceLast);
+    assert(pooled.Size() == 130 && source.Size() == 70 && *++pooled.Begin() == "s1" && source.Front() == "s0");
+    pooled.Splice(pooled.End(), source);
+    assert(source.Empty() && pooled.Size() == 200 && pooled.Back() == "s99");
+    source.Clear();
+    assert(pooled.Front() == "p0" && *--pooled.End() == "s99");
+
+    // element failing to move into a new node leaves no empty node behind.
+    UnrolledList<UnrolledFailingMove> failing;
+    for (size_t i = 0; i < UnrolledList<UnrolledFailingMove>::NodeCapacity; i++)
+    {
+        failing.Push_Back(UnrolledFailingMove(int(i)));
+    }
+    UnrolledFailingMove extra(-1);
+    UnrolledFailingMove::failMove = true;
+    try
+    {
+        failing.Push_Back(extra);
+        assert(false);
+    }
+    catch (const std::runtime_error& error)
+    {
+        cout << error.what() << endl;
+    }
+    UnrolledFailingMove::failMove = false;
+    size_t walked = 0;
+    for (auto& element : failing)
+    {
+        assert(element.value == int(walked));
+        ++walked;
+    }
+    assert(walked == failing.Size() && walked == UnrolledList<UnrolledFailingMove>::NodeCapacity);
+
+    cout << "end of test UnrolledList." << endl;
+}
+
+#endif
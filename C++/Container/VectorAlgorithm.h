@@ -0,0 +1,887 @@
+//**************************************************************
+//         SIMD algorithms for Vector of arithmetic types
+//**************************************************************
+
+#ifndef VECTORALGORITHM_H
+#define VECTORALGORITHM_H
+
+#include <iostream>
+#include <type_traits>
+#include <utility>
+#include "Vector.h"
+
+#if defined(_M_IX86) || defined(_M_X64) || defined(__i386__) || defined(__x86_64__)
+#define VECTOR_ALGORITHM_X86
+#ifdef _MSC_VER
+#include <intrin.h>
+#else
+#include <cpuid.h>
+#endif
+#include <immintrin.h>
+#endif
+
+using namespace std;
+
+// scanning column buffers like FindWithLegacyWay in Function/Lambda.h compares one element per iteration.
+// SIMD instructions compare 4~8 elements per instruction, here are kernels for Vector<int>,
+// Vector<float> and Vector<double>:
+//   Find, Count, Sum, MinMax, CountIfGreater, FilterGreater.
+// each one has a scalar version, a SSE4.2 version and an AVX2 version, the best version supported
+// by the cpu is selected at runtime via CPUID. so the binary still runs on old cpus.
+// other element types always use scalar version.
+
+// NOTE:
+// 1. Sum of float/double adds elements in different order than the scalar loop,
+//    so result may differ in the last bits of precision. Sum of int is accumulated in long long.
+// 2. MinMax does not handle NaN, and it is undefined for empty vector.
+
+/*******************************************************/
+// cpu feature detection
+/*******************************************************/
+
+enum SimdLevel
+{
+    SimdScalar,
+    SimdSSE42,
+    SimdAVX2
+};
+
+#ifdef VECTOR_ALGORITHM_X86
+
+// gcc/clang need target attribute to use intrinsics beyond compile options, msvc does not.
+#ifdef _MSC_VER
+#define SIMD_TARGET_SSE42
+#define SIMD_TARGET_AVX2
+#else
+#define SIMD_TARGET_SSE42 __attribute__((target("sse4.2,popcnt")))
+#define SIMD_TARGET_AVX2 __attribute__((target("avx2,popcnt")))
+#endif
+
+// registers are eax, ebx, ecx, edx.
+inline void CpuId(int leaf, int subleaf, unsigned registers[4])
+{
+#ifdef _MSC_VER
+    int values[4];
+    __cpuidex(values, leaf, subleaf);
+    for (int i = 0; i < 4; ++i)
+    {
+        registers[i] = unsigned(values[i]);
+    }
+#else
+    __cpuid_count(leaf, subleaf, registers[0], registers[1], registers[2], registers[3]);
+#endif
+}
+
+// read extended control register 0, which tells which register states os saves on context switch.
+inline unsigned long long ReadXcr0()
+{
+#ifdef _MSC_VER
+    return _xgetbv(0);
+#else
+    unsigned eax, edx;
+    __asm__ volatile("xgetbv" : "=a"(eax), "=d"(edx) : "c"(0));
+    return (static_cast<unsigned long long>(edx) << 32) | eax;
+#endif
+}
+
+inline SimdLevel DetectSimdLevel()
+{
+    unsigned registers[4];
+    CpuId(0, 0, registers);
+    unsigned maxLeaf = registers[0];
+
+    CpuId(1, 0, registers);
+    bool sse42 = (registers[2] & (1u << 20)) != 0;
+    bool popcnt = (registers[2] & (1u << 23)) != 0;
+    bool osxsave = (registers[2] & (1u << 27)) != 0;
+    bool avx = (registers[2] & (1u << 28)) != 0;
+    if (!sse42 || !popcnt)
+        return SimdScalar;
+
+    // AVX2 needs cpu support, and os to save ymm registers(xmm and ymm state bits in XCR0).
+    if (maxLeaf >= 7 && osxsave && avx && (ReadXcr0() & 0x6) == 0x6)
+    {
+        CpuId(7, 0, registers);
+        if ((registers[1] & (1u << 5)) != 0)
+            return SimdAVX2;
+    }
+
+    return SimdSSE42;
+}
+
+#else
+
+inline SimdLevel DetectSimdLevel()
+{
+    return SimdScalar;
+}
+
+#endif
+
+inline SimdLevel& CurrentSimdLevel()
+{
+    static SimdLevel level = DetectSimdLevel();
+    return level;
+}
+
+// SIMD level used by algorithms, detected on first use.
+inline SimdLevel GetSimdLevel()
+{
+    return CurrentSimdLevel();
+}
+
+// force algorithms to use a lower level, e.g. to compare kernels. level beyond cpu support is ignored.
+inline void SetSimdLevel(SimdLevel level)
+{
+    SimdLevel supported = DetectSimdLevel();
+    CurrentSimdLevel() = level < supported ? level : supported;
+}
+
+/*******************************************************/
+// scalar kernels, work for all arithmetic types.
+/*******************************************************/
+
+// type to accumulate Sum, int is widened to avoid overflow.
+template<typename T>
+struct SumType
+{
+    typedef typename std::conditional<std::is_integral<T>::value, long long, T>::type type;
+};
+
+template<typename T>
+const T* FindScalar(const T* first, const T* last, T value)
+{
+    for (; first != last; ++first)
+    {
+        if (*first == value)
+            break;
+    }
+    return first;
+}
+
+template<typename T>
+size_t CountScalar(const T* first, const T* last, T value)
+{
+    size_t count = 0;
+    for (; first != last; ++first)
+    {
+        count += (*first == value);
+    }
+    return count;
+}
+
+template<typename T>
+typename SumType<T>::type SumScalar(const T* first, const T* last)
+{
+    typename SumType<T>::type sum = 0;
+    for (; first != last; ++first)
+    {
+        sum += *first;
+    }
+    return sum;
+}
+
+template<typename T>
+std::pair<T, T> MinMaxScalar(const T* first, const T* last)
+{
+    T minValue = *first;
+    T maxValue = *first;
+    for (; first != last; ++first)
+    {
+        minValue = *first < minValue ? *first : minValue;
+        maxValue = *first > maxValue ? *first : maxValue;
+    }
+    return std::make_pair(minValue, maxValue);
+}
+
+template<typename T>
+size_t CountIfGreaterScalar(const T* first, const T* last, T bound)
+{
+    size_t count = 0;
+    for (; first != last; ++first)
+    {
+        count += (*first > bound);
+    }
+    return count;
+}
+
+// copy elements greater than bound to dest, dest must have room for all of [first, last).
+// return number of copied elements.
+template<typename T>
+size_t FilterGreaterScalar(const T* first, const T* last, T bound, T* dest)
+{
+    size_t count = 0;
+    for (; first != last; ++first)
+    {
+        // branchless: always write, only advance when element is qualified.
+        dest[count] = *first;
+        count += (*first > bound);
+    }
+    return count;
+}
+
+#ifdef VECTOR_ALGORITHM_X86
+
+/*******************************************************/
+// bit utilities for compare masks, bit i is set if lane i matches.
+/*******************************************************/
+
+inline int CountTrailingZeros(unsigned mask)
+{
+#ifdef _MSC_VER
+    unsigned long index;
+    _BitScanForward(&index, mask);
+    return int(index);
+#else
+    return __builtin_ctz(mask);
+#endif
+}
+
+// only called in kernels, where popcnt instruction is known to be supported.
+SIMD_TARGET_SSE42 inline int PopCount(unsigned mask)
+{
+#ifdef _MSC_VER
+    return int(__popcnt(mask));
+#else
+    return __builtin_popcount(mask);
+#endif
+}
+
+/*******************************************************/
+// SIMD operations for one element type and one instruction set.
+// generic kernels below are written with these operations.
+/*******************************************************/
+
+struct Sse42IntOps
+{
+    typedef int value_type;
+    typedef __m128i Vec;
+    typedef __m128i SumVec; // 2 x 64 bits
+    enum { Width = 4 };
+
+    SIMD_TARGET_SSE42 static Vec Load(const int* p) { return _mm_loadu_si128(reinterpret_cast<const __m128i*>(p)); }
+    SIMD_TARGET_SSE42 static void Store(int* p, Vec v) { _mm_storeu_si128(reinterpret_cast<__m128i*>(p), v); }
+    SIMD_TARGET_SSE42 static Vec Set1(int value) { return _mm_set1_epi32(value); }
+    SIMD_TARGET_SSE42 static unsigned EqualMask(Vec a, Vec b) { return _mm_movemask_ps(_mm_castsi128_ps(_mm_cmpeq_epi32(a, b))); }
+    SIMD_TARGET_SSE42 static unsigned GreaterMask(Vec a, Vec b) { return _mm_movemask_ps(_mm_castsi128_ps(_mm_cmpgt_epi32(a, b))); }
+    SIMD_TARGET_SSE42 static Vec Min(Vec a, Vec b) { return _mm_min_epi32(a, b); }
+    SIMD_TARGET_SSE42 static Vec Max(Vec a, Vec b) { return _mm_max_epi32(a, b); }
+    SIMD_TARGET_SSE42 static SumVec ZeroSum() { return _mm_setzero_si128(); }
+    SIMD_TARGET_SSE42 static SumVec AddSum(SumVec sum, Vec v)
+    {
+        // widen 4 x 32 bits to 2 x (2 x 64 bits) to avoid overflow.
+        __m128i low = _mm_cvtepi32_epi64(v);
+        __m128i high = _mm_cvtepi32_epi64(_mm_srli_si128(v, 8));
+        return _mm_add_epi64(sum, _mm_add_epi64(low, high));
+    }
+    SIMD_TARGET_SSE42 static long long ReduceSum(SumVec sum)
+    {
+        long long lanes[2];
+        _mm_storeu_si128(reinterpret_cast<__m128i*>(lanes), sum);
+        return lanes[0] + lanes[1];
+    }
+};
+
+struct Sse42FloatOps
+{
+    typedef float value_type;
+    typedef __m128 Vec;
+    typedef __m128 SumVec;
+    enum { Width = 4 };
+
+    SIMD_TARGET_SSE42 static Vec Load(const float* p) { return _mm_loadu_ps(p); }
+    SIMD_TARGET_SSE42 static void Store(float* p, Vec v) { _mm_storeu_ps(p, v); }
+    SIMD_TARGET_SSE42 static Vec Set1(float value) { return _mm_set1_ps(value); }
+    SIMD_TARGET_SSE42 static unsigned EqualMask(Vec a, Vec b) { return _mm_movemask_ps(_mm_cmpeq_ps(a, b)); }
+    SIMD_TARGET_SSE42 static unsigned GreaterMask(Vec a, Vec b) { return _mm_movemask_ps(_mm_cmpgt_ps(a, b)); }
+    SIMD_TARGET_SSE42 static Vec Min(Vec a, Vec b) { return _mm_min_ps(a, b); }
+    SIMD_TARGET_SSE42 static Vec Max(Vec a, Vec b) { return _mm_max_ps(a, b); }
+    SIMD_TARGET_SSE42 static SumVec ZeroSum() { return _mm_setzero_ps(); }
+    SIMD_TARGET_SSE42 static SumVec AddSum(SumVec sum, Vec v) { return _mm_add_ps(sum, v); }
+    SIMD_TARGET_SSE42 static float ReduceSum(SumVec sum)
+    {
+        float lanes[4];
+        _mm_storeu_ps(lanes, sum);
+        return (lanes[0] + lanes[1]) + (lanes[2] + lanes[3]);
+    }
+};
+
+struct Sse42DoubleOps
+{
+    typedef double value_type;
+    typedef __m128d Vec;
+    typedef __m128d SumVec;
+    enum { Width = 2 };
+
+    SIMD_TARGET_SSE42 static Vec Load(const double* p) { return _mm_loadu_pd(p); }
+    SIMD_TARGET_SSE42 static void Store(double* p, Vec v) { _mm_storeu_pd(p, v); }
+    SIMD_TARGET_SSE42 static Vec Set1(double value) { return _mm_set1_pd(value); }
+    SIMD_TARGET_SSE42 static unsigned EqualMask(Vec a, Vec b) { return _mm_movemask_pd(_mm_cmpeq_pd(a, b)); }
+    SIMD_TARGET_SSE42 static unsigned GreaterMask(Vec a, Vec b) { return _mm_movemask_pd(_mm_cmpgt_pd(a, b)); }
+    SIMD_TARGET_SSE42 static Vec Min(Vec a, Vec b) { return _mm_min_pd(a, b); }
+    SIMD_TARGET_SSE42 static Vec Max(Vec a, Vec b) { return _mm_max_pd(a, b); }
+    SIMD_TARGET_SSE42 static SumVec ZeroSum() { return _mm_setzero_pd(); }
+    SIMD_TARGET_SSE42 static SumVec AddSum(SumVec sum, Vec v) { return _mm_add_pd(sum, v); }
+    SIMD_TARGET_SSE42 static double ReduceSum(SumVec sum)
+    {
+        double lanes[2];
+        _mm_storeu_pd(lanes, sum);
+        return lanes[0] + lanes[1];
+    }
+};
+
+struct Avx2IntOps
+{
+    typedef int value_type;
+    typedef __m256i Vec;
+    typedef __m256i SumVec; // 4 x 64 bits
+    enum { Width = 8 };
+
+    SIMD_TARGET_AVX2 static Vec Load(const int* p) { return _mm256_loadu_si256(reinterpret_cast<const __m256i*>(p)); }
+    SIMD_TARGET_AVX2 static void Store(int* p, Vec v) { _mm256_storeu_si256(reinterpret_cast<__m256i*>(p), v); }
+    SIMD_TARGET_AVX2 static Vec Set1(int value) { return _mm256_set1_epi32(value); }
+    SIMD_TARGET_AVX2 static unsigned EqualMask(Vec a, Vec b) { return _mm256_movemask_ps(_mm256_castsi256_ps(_mm256_cmpeq_epi32(a, b))); }
+    SIMD_TARGET_AVX2 static unsigned GreaterMask(Vec a, Vec b) { return _mm256_movemask_ps(_mm256_castsi256_ps(_mm256_cmpgt_epi32(a, b))); }
+    SIMD_TARGET_AVX2 static Vec Min(Vec a, Vec b) { return _mm256_min_epi32(a, b); }
+    SIMD_TARGET_AVX2 static Vec Max(Vec a, Vec b) { return _mm256_max_epi32(a, b); }
+    SIMD_TARGET_AVX2 static SumVec ZeroSum() { return _mm256_setzero_si256(); }
+    SIMD_TARGET_AVX2 static SumVec AddSum(SumVec sum, Vec v)
+    {
+        // widen 8 x 32 bits to 2 x (4 x 64 bits) to avoid overflow.
+        __m256i low = _mm256_cvtepi32_epi64(_mm256_castsi256_si128(v));
+        __m256i high = _mm256_cvtepi32_epi64(_mm256_extracti128_si256(v, 1));
+        return _mm256_add_epi64(sum, _mm256_add_epi64(low, high));
+    }
+    SIMD_TARGET_AVX2 static long long ReduceSum(SumVec sum)
+    {
+        long long lanes[4];
+        _mm256_storeu_si256(reinterpret_cast<__m256i*>(lanes), sum);
+        return (lanes[0] + lanes[1]) + (lanes[2] + lanes[3]);
+    }
+};
+
+struct Avx2FloatOps
+{
+    typedef float value_type;
+    typedef __m256 Vec;
+    typedef __m256 SumVec;
+    enum { Width = 8 };
+
+    SIMD_TARGET_AVX2 static Vec Load(const float* p) { return _mm256_loadu_ps(p); }
+    SIMD_TARGET_AVX2 static void Store(float* p, Vec v) { _mm256_storeu_ps(p, v); }
+    SIMD_TARGET_AVX2 static Vec Set1(float value) { return _mm256_set1_ps(value); }
+    SIMD_TARGET_AVX2 static unsigned EqualMask(Vec a, Vec b) { return _mm256_movemask_ps(_mm256_cmp_ps(a, b, _CMP_EQ_OQ)); }
+    SIMD_TARGET_AVX2 static unsigned GreaterMask(Vec a, Vec b) { return _mm256_movemask_ps(_mm256_cmp_ps(a, b, _CMP_GT_OQ)); }
+    SIMD_TARGET_AVX2 static Vec Min(Vec a, Vec b) { return _mm256_min_ps(a, b); }
+    SIMD_TARGET_AVX2 static Vec Max(Vec a, Vec b) { return _mm256_max_ps(a, b); }
+    SIMD_TARGET_AVX2 static SumVec ZeroSum() { return _mm256_setzero_ps(); }
+    SIMD_TARGET_AVX2 static SumVec AddSum(SumVec sum, Vec v) { return _mm256_add_ps(sum, v); }
+    SIMD_TARGET_AVX2 static float ReduceSum(SumVec sum)
+    {
+        float lanes[8];
+        _mm256_storeu_ps(lanes, sum);
+        return ((lanes[0] + lanes[1]) + (lanes[2] + lanes[3])) + ((lanes[4] + lanes[5]) + (lanes[6] + lanes[7]));
+    }
+};
+
+struct Avx2DoubleOps
+{
+    typedef double value_type;
+    typedef __m256d Vec;
+    typedef __m256d SumVec;
+    enum { Width = 4 };
+
+    SIMD_TARGET_AVX2 static Vec Load(const double* p) { return _mm256_loadu_pd(p); }
+    SIMD_TARGET_AVX2 static void Store(double* p, Vec v) { _mm256_storeu_pd(p, v); }
+    SIMD_TARGET_AVX2 static Vec Set1(double value) { return _mm256_set1_pd(value); }
+    SIMD_TARGET_AVX2 static unsigned EqualMask(Vec a, Vec b) { return _mm256_movemask_pd(_mm256_cmp_pd(a, b, _CMP_EQ_OQ)); }
+    SIMD_TARGET_AVX2 static unsigned GreaterMask(Vec a, Vec b) { return _mm256_movemask_pd(_mm256_cmp_pd(a, b, _CMP_GT_OQ)); }
+    SIMD_TARGET_AVX2 static Vec Min(Vec a, Vec b) { return _mm256_min_pd(a, b); }
+    SIMD_TARGET_AVX2 static Vec Max(Vec a, Vec b) { return _mm256_max_pd(a, b); }
+    SIMD_TARGET_AVX2 static SumVec ZeroSum() { return _mm256_setzero_pd(); }
+    SIMD_TARGET_AVX2 static SumVec AddSum(SumVec sum, Vec v) { return _mm256_add_pd(sum, v); }
+    SIMD_TARGET_AVX2 static double ReduceSum(SumVec sum)
+    {
+        double lanes[4];
+        _mm256_storeu_pd(lanes, sum);
+        return (lanes[0] + lanes[1]) + (lanes[2] + lanes[3]);
+    }
+};
+
+// SIMD operations for each element type, void if there is no kernel for it.
+template<typename T>
+struct SimdOps
+{
+    typedef void Sse42;
+    typedef void Avx2;
+};
+
+template<>
+struct SimdOps<int>
+{
+    typedef Sse42IntOps Sse42;
+    typedef Avx2IntOps Avx2;
+};
+
+template<>
+struct SimdOps<float>
+{
+    typedef Sse42FloatOps Sse42;
+    typedef Avx2FloatOps Avx2;
+};
+
+template<>
+struct SimdOps<double>
+{
+    typedef Sse42DoubleOps Sse42;
+    typedef Avx2DoubleOps Avx2;
+};
+
+template<typename T>
+struct HasSimdKernels : std::integral_constant<bool, !std::is_void<typename SimdOps<T>::Sse42>::value>
+{
+};
+
+/*******************************************************/
+// generic SIMD kernels.
+// each kernel processes Width elements per iteration, left tail goes to scalar kernel.
+// kernels are written twice since target attribute of gcc cannot be a template parameter,
+// Sse42 ones are only instantiated with Sse42 ops, Avx2 ones with Avx2 ops.
+/*******************************************************/
+
+template<typename Ops, typename T>
+SIMD_TARGET_SSE42 const T* FindSse42(const T* first, const T* last, T value)
+{
+    typename Ops::Vec target = Ops::Set1(value);
+    for (; last - first >= Ops::Width; first += Ops::Width)
+    {
+        unsigned mask = Ops::EqualMask(Ops::Load(first), target);
+        if (mask != 0)
+            return first + CountTrailingZeros(mask);
+    }
+    return FindScalar(first, last, value);
+}
+
+template<typename Ops, typename T>
+SIMD_TARGET_SSE42 size_t CountSse42(const T* first, const T* last, T value)
+{
+    typename Ops::Vec target = Ops::Set1(value);
+    size_t count = 0;
+    for (; last - first >= Ops::Width; first += Ops::Width)
+    {
+        count += PopCount(Ops::EqualMask(Ops::Load(first), target));
+    }
+    return count + CountScalar(first, last, value);
+}
+
+template<typename Ops, typename T>
+SIMD_TARGET_SSE42 typename SumType<T>::type SumSse42(const T* first, const T* last)
+{
+    typename Ops::SumVec sum = Ops::ZeroSum();
+    for (; last - first >= Ops::Width; first += Ops::Width)
+    {
+        sum = Ops::AddSum(sum, Ops::Load(first));
+    }
+    return Ops::ReduceSum(sum) + SumScalar(first, last);
+}
+
+template<typename Ops, typename T>
+SIMD_TARGET_SSE42 std::pair<T, T> MinMaxSse42(const T* first, const T* last)
+{
+    if (last - first < Ops::Width)
+        return MinMaxScalar(first, last);
+
+    typename Ops::Vec minVec = Ops::Load(first);
+    typename Ops::Vec maxVec = minVec;
+    for (first += Ops::Width; last - first >= Ops::Width; first += Ops::Width)
+    {
+        typename Ops::Vec v = Ops::Load(first);
+        minVec = Ops::Min(minVec, v);
+        maxVec = Ops::Max(maxVec, v);
+    }
+
+    // reduce lanes and tail together.
+    T lanes[Ops::Width * 2];
+    Ops::Store(lanes, minVec);
+    Ops::Store(lanes + Ops::Width, maxVec);
+    std::pair<T, T> result = MinMaxScalar(lanes, lanes + Ops::Width);
+    result.second = MinMaxScalar(lanes + Ops::Width, lanes + Ops::Width * 2).second;
+    if (first != last)
+    {
+        std::pair<T, T> tail = MinMaxScalar(first, last);
+        result.first = tail.first < result.first ? tail.first : result.first;
+        result.second = tail.second > result.second ? tail.second : result.second;
+    }
+    return result;
+}
+
+template<typename Ops, typename T>
+SIMD_TARGET_SSE42 size_t CountIfGreaterSse42(const T* first, const T* last, T bound)
+{
+    typename Ops::Vec boundVec = Ops::Set1(bound);
+    size_t count = 0;
+    for (; last - first >= Ops::Width; first += Ops::Width)
+    {
+        count += PopCount(Ops::GreaterMask(Ops::Load(first), boundVec));
+    }
+    return count + CountIfGreaterScalar(first, last, bound);
+}
+
+template<typename Ops, typename T>
+SIMD_TARGET_SSE42 size_t FilterGreaterSse42(const T* first, const T* last, T bound, T* dest)
+{
+    typename Ops::Vec boundVec = Ops::Set1(bound);
+    size_t count = 0;
+    for (; last - first >= Ops::Width; first += Ops::Width)
+    {
+        unsigned mask = Ops::GreaterMask(Ops::Load(first), boundVec);
+        // copy qualified lanes one by one, blocks without any match are skipped at once.
+        while (mask != 0)
+        {
+            dest[count++] = first[CountTrailingZeros(mask)];
+            mask &= mask - 1;
+        }
+    }
+    return count + FilterGreaterScalar(first, last, bound, dest + count);
+}
+
+template<typename Ops, typename T>
+SIMD_TARGET_AVX2 const T* FindAvx2(const T* first, const T* last, T value)
+{
+    typename Ops::Vec target = Ops::Set1(value);
+    for (; last - first >= Ops::Width; first += Ops::Width)
+    {
+        unsigned mask = Ops::EqualMask(Ops::Load(first), target);
+        if (mask != 0)
+            return first + CountTrailingZeros(mask);
+    }
+    return FindScalar(first, last, value);
+}
+
+template<typename Ops, typename T>
+SIMD_TARGET_AVX2 size_t CountAvx2(const T* first, const T* last, T value)
+{
+    typename Ops::Vec target = Ops::Set1(value);
+    size_t count = 0;
+    for (; last - first >= Ops::Width; first += Ops::Width)
+    {
+        count += PopCount(Ops::EqualMask(Ops::Load(first), target));
+    }
+    return count + CountScalar(first, last, value);
+}
+
+template<typename Ops, typename T>
+SIMD_TARGET_AVX2 typename SumType<T>::type SumAvx2(const T* first, const T* last)
+{
+    typename Ops::SumVec sum = Ops::ZeroSum();
+    for (; last - first >= Ops::Width; first += Ops::Width)
+    {
+        sum = Ops::AddSum(sum, Ops::Load(first));
+    }
+    return Ops::ReduceSum(sum) + SumScalar(first, last);
+}
+
+template<typename Ops, typename T>
+SIMD_TARGET_AVX2 std::pair<T, T> MinMaxAvx2(const T* first, const T* last)
+{
+    if (last - first < Ops::Width)
+        return MinMaxScalar(first, last);
+
+    typename Ops::Vec minVec = Ops::Load(first);
+    typename Ops::Vec maxVec = minVec;
+    for (first += Ops::Width; last - first >= Ops::Width; first += Ops::Width)
+    {
+        typename Ops::Vec v = Ops::Load(first);
+        minVec = Ops::Min(minVec, v);
+        maxVec = Ops::Max(maxVec, v);
+    }
+
+    // reduce lanes and tail together.
+    T lanes[Ops::Width * 2];
+    Ops::Store(lanes, minVec);
+    Ops::Store(lanes + Ops::Width, maxVec);
+    std::pair<T, T> result = MinMaxScalar(lanes, lanes + Ops::Width);
+    result.second = MinMaxScalar(lanes + Ops::Width, lanes + Ops::Width * 2).second;
+    if (first != last)
+    {
+        std::pair<T, T> tail = MinMaxScalar(first, last);
+        result.first = tail.first < result.first ? tail.first : result.first;
+        result.second = tail.second > result.second ? tail.second : result.second;
+    }
+    return result;
+}
+
+template<typename Ops, typename T>
+SIMD_TARGET_AVX2 size_t CountIfGreaterAvx2(const T* first, const T* last, T bound)
+{
+    typename Ops::Vec boundVec = Ops::Set1(bound);
+    size_t count = 0;
+    for (; last - first >= Ops::Width; first += Ops::Width)
+    {
+        count += PopCount(Ops::GreaterMask(Ops::Load(first), boundVec));
+    }
+    return count + CountIfGreaterScalar(first, last, bound);
+}
+
+template<typename Ops, typename T>
+SIMD_TARGET_AVX2 size_t FilterGreaterAvx2(const T* first, const T* last, T bound, T* dest)
+{
+    typename Ops::Vec boundVec = Ops::Set1(bound);
+    size_t count = 0;
+    for (; last - first >= Ops::Width; first += Ops::Width)
+    {
+        unsigned mask = Ops::GreaterMask(Ops::Load(first), boundVec);
+        // copy qualified lanes one by one, blocks without any match are skipped at once.
+        while (mask != 0)
+        {
+            dest[count++] = first[CountTrailingZeros(mask)];
+            mask &= mask - 1;
+        }
+    }
+    return count + FilterGreaterScalar(first, last, bound, dest + count);
+}
+
+#endif
+
+/*******************************************************/
+// dispatch on element type(has kernel or not) and runtime SIMD level.
+/*******************************************************/
+
+template<typename T>
+const T* FindRange(const T* first, const T* last, T value, std::false_type)
+{
+    return FindScalar(first, last, value);
+}
+
+template<typename T>
+size_t CountRange(const T* first, const T* last, T value, std::false_type)
+{
+    return CountScalar(first, last, value);
+}
+
+template<typename T>
+typename SumType<T>::type SumRange(const T* first, const T* last, std::false_type)
+{
+    return SumScalar(first, last);
+}
+
+template<typename T>
+std::pair<T, T> MinMaxRange(const T* first, const T* last, std::false_type)
+{
+    return MinMaxScalar(first, last);
+}
+
+template<typename T>
+size_t CountIfGreaterRange(const T* first, const T* last, T bound, std::false_type)
+{
+    return CountIfGreaterScalar(first, last, bound);
+}
+
+template<typename T>
+size_t FilterGreaterRange(const T* first, const T* last, T bound, T* dest, std::false_type)
+{
+    return FilterGreaterScalar(first, last, bound, dest);
+}
+
+#ifdef VECTOR_ALGORITHM_X86
+
+template<typename T>
+const T* FindRange(const T* first, const T* last, T value, std::true_type)
+{
+    switch (GetSimdLevel())
+    {
+    case SimdAVX2:
+        return FindAvx2<typename SimdOps<T>::Avx2>(first, last, value);
+    case SimdSSE42:
+        return FindSse42<typename SimdOps<T>::Sse42>(first, last, value);
+    default:
+        return FindScalar(first, last, value);
+    }
+}
+
+template<typename T>
+size_t CountRange(const T* first, const T* last, T value, std::true_type)
+{
+    switch (GetSimdLevel())
+    {
+    case SimdAVX2:
+        return CountAvx2<typename SimdOps<T>::Avx2>(first, last, value);
+    case SimdSSE42:
+        return CountSse42<typename SimdOps<T>::Sse42>(first, last, value);
+    default:
+        return CountScalar(first, last, value);
+    }
+}
+
+template<typename T>
+typename SumType<T>::type SumRange(const T* first, const T* last, std::true_type)
+{
+    switch (GetSimdLevel())
+    {
+    case SimdAVX2:
+        return SumAvx2<typename SimdOps<T>::Avx2>(first, last);
+    case SimdSSE42:
+        return SumSse42<typename SimdOps<T>::Sse42>(first, last);
+    default:
+        return SumScalar(first, last);
+    }
+}
+
+template<typename T>
+std::pair<T, T> MinMaxRange(const T* first, const T* last, std::true_type)
+{
+    switch (GetSimdLevel())
+    {
+    case SimdAVX2:
+        return MinMaxAvx2<typename SimdOps<T>::Avx2>(first, last);
+    case SimdSSE42:
+        return MinMaxSse42<typename SimdOps<T>::Sse42>(first, last);
+    default:
+        return MinMaxScalar(first, last);
+    }
+}
+
+template<typename T>
+size_t CountIfGreaterRange(const T* first, const T* last, T bound, std::true_type)
+{
+    switch (GetSimdLevel())
+    {
+    case SimdAVX2:
+        return CountIfGreaterAvx2<typename SimdOps<T>::Avx2>(first, last, bound);
+    case SimdSSE42:
+        return CountIfGreaterSse42<typename SimdOps<T>::Sse42>(first, last, bound);
+    default:
+        return CountIfGreaterScalar(first, last, bound);
+    }
+}
+
+template<typename T>
+size_t FilterGreaterRange(const T* first, const T* last, T bound, T* dest, std::true_type)
+{
+    switch (GetSimdLevel())
+    {
+    case SimdAVX2:
+        return FilterGreaterAvx2<typename SimdOps<T>::Avx2>(first, last, bound, dest);
+    case SimdSSE42:
+        return FilterGreaterSse42<typename SimdOps<T>::Sse42>(first, last, bound, dest);
+    default:
+        return FilterGreaterScalar(first, last, bound, dest);
+    }
+}
+
+#else
+
+template<typename T>
+struct HasSimdKernels : std::false_type
+{
+};
+
+#endif
+
+/*******************************************************/
+// algorithms on Vector
+/*******************************************************/
+
+// Returns iterator to the first element equal to value, or End() if there is no such element.
+template<typename T, typename Alloc, typename Growth>
+typename Vector<T, Alloc, Growth>::iterator Find(const Vector<T, Alloc, Growth>& vec, T value)
+{
+    return const_cast<T*>(FindRange<T>(vec.Begin(), vec.End(), value, HasSimdKernels<T>()));
+}
+
+// Returns number of elements equal to value.
+template<typename T, typename Alloc, typename Growth>
+size_t Count(const Vector<T, Alloc, Growth>& vec, T value)
+{
+    return CountRange<T>(vec.Begin(), vec.End(), value, HasSimdKernels<T>());
+}
+
+// Returns sum of all elements, integral elements are summed in long long.
+template<typename T, typename Alloc, typename Growth>
+typename SumType<T>::type Sum(const Vector<T, Alloc, Growth>& vec)
+{
+    return SumRange<T>(vec.Begin(), vec.End(), HasSimdKernels<T>());
+}
+
+// Returns pair of smallest and largest element, vector must not be empty.
+template<typename T, typename Alloc, typename Growth>
+std::pair<T, T> MinMax(const Vector<T, Alloc, Growth>& vec)
+{
+    return MinMaxRange<T>(vec.Begin(), vec.End(), HasSimdKernels<T>());
+}
+
+// Returns number of elements greater than bound.
+template<typename T, typename Alloc, typename Growth>
+size_t CountIfGreater(const Vector<T, Alloc, Growth>& vec, T bound)
+{
+    return CountIfGreaterRange<T>(vec.Begin(), vec.End(), bound, HasSimdKernels<T>());
+}
+
+// Appends elements greater than bound to output, in their original order.
+// Returns number of appended elements.
+template<typename T, typename Alloc, typename Growth, typename OutAlloc, typename OutGrowth>
+size_t FilterGreater(const Vector<T, Alloc, Growth>& vec, T bound, Vector<T, OutAlloc, OutGrowth>& output)
+{
+    // make room for the worst case without initializing it, then shrink to what is really written.
+    size_t oldSize = output.Size();
+    output.Resize_Default_Init(oldSize + vec.Size());
+    size_t count = FilterGreaterRange<T>(vec.Begin(), vec.End(), bound, output.Data() + oldSize, HasSimdKernels<T>());
+    output.Resize(oldSize + count);
+    return count;
+}
+
+// test routines for vector algorithm, compare results of every level with scalar version.
+template<typename T>
+void TestVectorAlgorithmOf(const char* name)
+{
+    bool passed = true;
+    // lengths around SIMD width to cover tails.
+    for (size_t size = 1; size < 40; ++size)
+    {
+        Vector<T> vec;
+        for (size_t i = 0; i < size; ++i)
+        {
+            vec.Push_Back(T((i * 7) % 11));
+        }
+
+        const T* first = vec.Begin();
+        const T* last = vec.End();
+        for (int level = SimdScalar; level <= SimdAVX2; ++level)
+        {
+            SetSimdLevel(SimdLevel(level));
+
+            Vector<T> filtered;
+            size_t filteredCount = FilterGreater(vec, T(5), filtered);
+            Vector<T> expected(size, For_Overwrite);
+            expected.Resize(FilterGreaterScalar(first, last, T(5), expected.Data()));
+
+            passed = passed
+                && Find(vec, T(10)) == FindScalar(first, last, T(10))
+                && Find(vec, T(12)) == vec.End()
+                && Count(vec, T(3)) == CountScalar(first, last, T(3))
+                && Sum(vec) == SumScalar(first, last) // small integers, exact even for float.
+                && MinMax(vec) == MinMaxScalar(first, last)
+                && CountIfGreater(vec, T(5)) == CountIfGreaterScalar(first, last, T(5))
+                && filteredCount == expected.Size()
+                && std::equal(filtered.Begin(), filtered.End(), expected.Begin());
+        }
+    }
+    SetSimdLevel(SimdAVX2);
+
+    cout << "vector algorithm of " << name << (passed ? " passed." : " FAILED.") << endl;
+}
+
+void TestVectorAlgorithm()
+{
+    static const char* levelNames[] = { "scalar", "SSE4.2", "AVX2" };
+    cout << "SIMD level: " << levelNames[GetSimdLevel()] << endl;
+
+    TestVectorAlgorithmOf<int>("int");
+    TestVectorAlgorithmOf<float>("float");
+    TestVectorAlgorithmOf<double>("double");
+    TestVectorAlgorithmOf<short>("short"); // no kernel, scalar only.
+
+    cout << "end of test vector algorithm." << endl;
+}
+
+#endif
@@ -0,0 +1,88 @@
+//**************************************************************
+//         allocator returning storage of given alignment
+//**************************************************************
+#ifndef ALIGNED_ALLOCATOR_H
+#define ALIGNED_ALLOCATOR_H
+
+#include <cstdint>
+#include <new>
+#include "Allocator.h"
+
+using namespace std;
+
+// operator new only guarantees alignment of max_align_t(8 or 16 bytes).
+// SIMD loads are fastest when they do not cross cache lines, so arrays which are scanned by SIMD
+// code are aligned to cache line(64 bytes, also the width of AVX-512 register) here.
+// storage is over-allocated by Alignment bytes, pointer returned by operator new is stored
+// right before the aligned block to free it later. Alignment must be a power of 2 and at least sizeof(void*).
+template<typename T, size_t Alignment = 64>
+class AlignedAllocator : public Allocator<T>
+{
+public:
+    typedef T value_type;
+    typedef value_type* pointer;
+    typedef size_t size_type;
+
+    static_assert((Alignment & (Alignment - 1)) == 0 && Alignment >= sizeof(void*), "alignment should be power of 2.");
+
+    template<typename U>
+    struct rebind
+    {
+        typedef AlignedAllocator<U, Alignment> other;
+    };
+
+    AlignedAllocator()
+    {
+    }
+
+    AlignedAllocator(const AlignedAllocator&)
+    {
+    }
+
+    template<typename U>
+    AlignedAllocator(const AlignedAllocator<U, Alignment>&)
+    {
+    }
+
+    pointer allocate(size_type count)
+    {
+        if (count == 0)
+            return nullptr;
+        if ((size_t(-1) - Alignment) / sizeof(T) < count)
+            throw std::out_of_range("bad allocation.");
+
+        char* raw = (char*)::operator new(count * sizeof(T) + Alignment);
+        // at least sizeof(void*) bytes are left before aligned block to keep raw pointer.
+        char* aligned = (char*)(((uintptr_t)raw + Alignment) & ~uintptr_t(Alignment - 1));
+        ((void**)aligned)[-1] = raw;
+        return (T*)aligned;
+    }
+
+    void deallocate(pointer ptr, size_type)
+    {
+        if (ptr != nullptr)
+        {
+            ::operator delete(((void**)ptr)[-1]);
+        }
+    }
+
+    // ptr is inside the block of operator new, malloc can not be asked about it.
+    size_type usable_size(const T*, size_type count) const
+    {
+        return count;
+    }
+};
+
+template<typename T, typename U, size_t Alignment>
+bool operator==(const AlignedAllocator<T, Alignment>&, const AlignedAllocator<U, Alignment>&)
+{
+    return true;
+}
+
+template<typename T, typename U, size_t Alignment>
+bool operator!=(const AlignedAllocator<T, Alignment>&, const AlignedAllocator<U, Alignment>&)
+{
+    return false;
+}
+
+#endif
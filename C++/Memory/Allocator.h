@@ -5,6 +5,14 @@
 #define ALLOCATOR_H
 
 #include <iostream>
+#include <type_traits>
+#include <utility>
+
+#if defined(_WIN32) || defined(__linux__)
+#include <malloc.h>
+#elif defined(__APPLE__)
+#include <malloc/malloc.h>
+#endif
 
 using namespace std;
 
@@ -92,6 +100,13 @@ public:
         ::new(ptr) T(ref);
     }
 
+    // constructs T in-place with arguments forwarded to its ctor, no temporary T is created.
+    template<typename... Args>
+    void construct(pointer ptr, Args&&... args)
+    {
+        ::new(ptr) T(std::forward<Args>(args)...);
+    }
+
     void destroy(pointer ptr)
     {
         ptr->~T();
@@ -102,7 +117,88 @@ public:
     {
         return (size_t(-1) / sizeof(T));
     }
+
+    // Returns number of objects which fit in the block malloc would give for count objects.
+    // malloc serves requests from size classes, rest of the class is slack that is paid anyway.
+    // only jemalloc tells the class before allocating(nallocx), it is asked if <jemalloc/jemalloc.h>
+    // is included first. otherwise count is returned, usable_size finds the slack after allocating.
+    size_type good_size(size_type count) const
+    {
+#if defined(JEMALLOC_VERSION)
+        if (count == 0)
+            return 0;
+        return nallocx(count * sizeof(T), 0) / sizeof(T);
+#else
+        return count;
+#endif
+    }
+
+    // Returns number of objects which fit in the block ptr, allocated for count objects,
+    // as reported by the malloc in use(malloc_usable_size, _msize, malloc_size).
+    // count itself if the platform cannot tell.
+    size_type usable_size(const_pointer ptr, size_type count) const
+    {
+        if (ptr == nullptr)
+            return count;
+
+#if defined(_WIN32)
+        size_t bytes = _msize(const_cast<T*>(ptr));
+#elif defined(__linux__)
+        size_t bytes = malloc_usable_size(const_cast<T*>(ptr));
+#elif defined(__APPLE__)
+        size_t bytes = malloc_size(ptr);
+#else
+        size_t bytes = count * sizeof(T);
+#endif
+        return bytes / sizeof(T);
+    }
+private:
+};
+
+// all Allocators share operator new, storage of one can be freed by any other.
+template<typename T, typename U>
+bool operator==(const Allocator<T>&, const Allocator<U>&)
+{
+    return true;
+}
+
+template<typename T, typename U>
+bool operator!=(const Allocator<T>&, const Allocator<U>&)
+{
+    return false;
+}
+
+// HasReallocate<Alloc>::value is true if Alloc provides reallocate(ptr, oldCount, newCount),
+// which resizes storage keeping its bytes, e.g. by realloc or mremap.
+// containers use it to grow storage of trivially relocatable objects without copying them.
+template<typename Alloc>
+struct HasReallocate
+{
 private:
+    template<typename A>
+    static auto Test(int) -> decltype(std::declval<A&>().reallocate(nullptr, 0, 0), std::true_type());
+
+    template<typename A>
+    static std::false_type Test(...);
+
+public:
+    static const bool value = decltype(Test<Alloc>(0))::value;
+};
+
+// HasReleaseAll<Alloc>::value is true if Alloc provides release_all() to free all its storage at once.
+// containers use it to drop all nodes in one go when they are cleared.
+template<typename Alloc>
+struct HasReleaseAll
+{
+private:
+    template<typename A>
+    static auto Test(int) -> decltype(std::declval<A&>().release_all(), std::true_type());
+
+    template<typename A>
+    static std::false_type Test(...);
+
+public:
+    static const bool value = decltype(Test<Alloc>(0))::value;
 };
 
 void TestAllocator()
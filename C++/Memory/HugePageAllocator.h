@@ -0,0 +1,298 @@
+//**************************************************************
+//         allocator backing large buffers with huge pages
+//**************************************************************
+#ifndef HUGE_PAGE_ALLOCATOR_H
+#define HUGE_PAGE_ALLOCATOR_H
+
+#include <cstring>
+#include <new>
+#include "Allocator.h"
+
+#if defined(_WIN32)
+#ifndef NOMINMAX
+#define NOMINMAX
+#endif
+#include <windows.h>
+#else
+#include <sys/mman.h>
+#endif
+
+using namespace std;
+
+// a 4KB page costs one TLB entry, scanning 1GB buffer walks 262144 pages and misses TLB all the time.
+// a 2MB huge page covers 512 normal pages with one entry, so large buffers are mapped by huge pages here:
+// 1. blocks from LargeBlockSize bytes are mapped directly from OS(mmap/VirtualAlloc), rounded up to
+//    2MB and aligned to 2MB so they can be backed by huge pages. on linux the region is marked with
+//    MADV_HUGEPAGE for transparent huge pages, or taken from the reserved hugetlbfs pool(MAP_HUGETLB)
+//    if ExplicitHugePages is true. it falls back to normal pages if the pool is empty.
+//    windows needs SeLockMemoryPrivilege for MEM_LARGE_PAGES, it falls back to normal pages as well.
+// 2. smaller blocks come from operator new as Allocator<T>, mapping them would waste most of a page.
+//
+// reallocate(ptr, oldCount, newCount) grows a mapped block by mremap on linux, which moves page table
+// entries instead of copying bytes, so growing a 1GB vector costs no copy at all. Vector uses it
+// for trivially relocatable elements.
+template<typename T, bool ExplicitHugePages = false>
+class HugePageAllocator : public Allocator<T>
+{
+public:
+    typedef T value_type;
+    typedef value_type* pointer;
+    typedef size_t size_type;
+
+    // huge page size of x86-64 and arm64(4KB granule).
+    static const size_t HugePageSize = 2 * 1024 * 1024;
+    // blocks from this size are mapped from OS.
+    static const size_t LargeBlockSize = 1024 * 1024;
+
+    template<typename U>
+    struct rebind
+    {
+        typedef HugePageAllocator<U, ExplicitHugePages> other;
+    };
+
+    HugePageAllocator()
+    {
+    }
+
+    HugePageAllocator(const HugePageAllocator&)
+    {
+    }
+
+    template<typename U>
+    HugePageAllocator(const HugePageAllocator<U, ExplicitHugePages>&)
+    {
+    }
+
+    pointer allocate(size_type count)
+    {
+        if (count == 0)
+            return nullptr;
+        if ((size_t(-1) - HugePageSize) / sizeof(T) < count)
+            throw std::out_of_range("bad allocation.");
+
+        size_t bytes = count * sizeof(T);
+        if (!IsLargeBlock(bytes))
+            return (T*)::operator new(bytes);
+
+        return (T*)MapBlock(RoundToHugePage(bytes));
+    }
+
+    // count must match the value previously passed to allocate(or reallocate).
+    void deallocate(pointer ptr, size_type count)
+    {
+        if (ptr == nullptr)
+            return;
+
+        size_t bytes = count * sizeof(T);
+        if (!IsLargeBlock(bytes))
+            ::operator delete(ptr);
+        else
+            UnmapBlock(ptr, RoundToHugePage(bytes));
+    }
+
+    // grow or shrink storage allocated for oldCount objects to newCount objects, keeping the bytes
+    // of the first min(oldCount, newCount) objects. so it is only for objects which can be moved as bytes.
+    // Returns new storage, old storage is released. on failure exception is thrown and ptr is still valid.
+    pointer reallocate(pointer ptr, size_type oldCount, size_type newCount)
+    {
+        size_t oldBytes = oldCount * sizeof(T);
+        size_t newBytes = newCount * sizeof(T);
+#if defined(__linux__)
+        if (ptr != nullptr && IsLargeBlock(oldBytes) && IsLargeBlock(newBytes) && (size_t(-1) - HugePageSize) / sizeof(T) >= newCount)
+        {
+            size_t oldMapped = RoundToHugePage(oldBytes);
+            size_t newMapped = RoundToHugePage(newBytes);
+            if (oldMapped == newMapped)
+                return ptr;
+
+            // the kernel moves page table entries instead of bytes. resizing in place keeps the alignment.
+            void* block = ::mremap(ptr, oldMapped, newMapped, 0);
+#if defined(MREMAP_FIXED)
+            if (block == MAP_FAILED)
+            {
+                // MREMAP_MAYMOVE alone may move the pages to any page boundary, which splits huge pages,
+                // so they are moved into a reserved 2MB aligned range.
+                void* target = MapAligned(newMapped, PROT_NONE);
+                if (target != nullptr)
+                {
+                    block = ::mremap(ptr, oldMapped, newMapped, MREMAP_MAYMOVE | MREMAP_FIXED, target);
+                    if (block == MAP_FAILED)
+                        ::munmap(target, newMapped);
+                }
+            }
+#endif
+            if (block != MAP_FAILED)
+            {
+                AdviseHugePages(block, newMapped);
+                return (T*)block;
+            }
+            // mremap fails on hugetlbfs mappings of older kernels, copy to a new mapping then.
+        }
+#endif
+        // no remap(windows, small blocks, failed remap), copy to new storage.
+        pointer newPtr = allocate(newCount);
+        if (ptr != nullptr)
+        {
+            std::memcpy(static_cast<void*>(newPtr), static_cast<const void*>(ptr), (oldBytes < newBytes ? oldBytes : newBytes));
+            deallocate(ptr, oldCount);
+        }
+        return newPtr;
+    }
+
+    // Returns number of objects which fit in the block really given for count objects.
+    // mapped blocks are whole huge pages, so GrowthSizeClass policy turns the tail of last page into capacity.
+    size_type good_size(size_type count) const
+    {
+        size_t bytes = count * sizeof(T);
+        if (!IsLargeBlock(bytes))
+            return Allocator<T>::good_size(count);
+
+        return RoundToHugePage(bytes) / sizeof(T);
+    }
+
+    // mapped blocks are not known to malloc, they hold whole huge pages.
+    // slack of a small block is capped below LargeBlockSize, deallocate tells blocks apart by count.
+    size_type usable_size(const T* ptr, size_type count) const
+    {
+        size_t bytes = count * sizeof(T);
+        if (!IsLargeBlock(bytes))
+        {
+            size_t usable = Allocator<T>::usable_size(ptr, count);
+            size_t maxSmall = (LargeBlockSize - 1) / sizeof(T);
+            return usable < maxSmall ? usable : maxSmall;
+        }
+
+        return RoundToHugePage(bytes) / sizeof(T);
+    }
+
+private:
+    static bool IsLargeBlock(size_t bytes)
+    {
+        return bytes >= LargeBlockSize;
+    }
+
+    static size_t RoundToHugePage(size_t bytes)
+    {
+        return (bytes + HugePageSize - 1) / HugePageSize * HugePageSize;
+    }
+
+#if defined(_WIN32)
+    static void* MapBlock(size_t bytes)
+    {
+        void* block = nullptr;
+        size_t largePage = ::GetLargePageMinimum();
+        if (ExplicitHugePages && largePage != 0 && bytes % largePage == 0)
+        {
+            block = ::VirtualAlloc(nullptr, bytes, MEM_RESERVE | MEM_COMMIT | MEM_LARGE_PAGES, PAGE_READWRITE);
+        }
+        if (block == nullptr)
+        {
+            block = ::VirtualAlloc(nullptr, bytes, MEM_RESERVE | MEM_COMMIT, PAGE_READWRITE);
+        }
+        if (block == nullptr)
+            throw std::bad_alloc();
+
+        return block;
+    }
+
+    static void UnmapBlock(void* block, size_t)
+    {
+        ::VirtualFree(block, 0, MEM_RELEASE);
+    }
+#else
+    static void* MapBlock(size_t bytes)
+    {
+#if defined(MAP_HUGETLB)
+        if (ExplicitHugePages)
+        {
+            // hugetlbfs pages are always aligned and never swapped, but the pool must be reserved
+            // by administrator(vm.nr_hugepages).
+            void* block = ::mmap(nullptr, bytes, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS | MAP_HUGETLB, -1, 0);
+            if (block != MAP_FAILED)
+                return block;
+        }
+#endif
+        void* block = MapAligned(bytes, PROT_READ | PROT_WRITE);
+        if (block == nullptr)
+            throw std::bad_alloc();
+
+        AdviseHugePages(block, bytes);
+        return block;
+    }
+
+    // maps bytes aligned to 2MB with protection prot. Returns nullptr on failure.
+    // mmap only aligns to normal page, map one more huge page and trim both ends to align it,
+    // kernel can only back 2MB aligned ranges by huge pages.
+    static void* MapAligned(size_t bytes, int prot)
+    {
+        size_t mapped = bytes + HugePageSize;
+        char* block = (char*)::mmap(nullptr, mapped, prot, MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+        if ((void*)block == MAP_FAILED)
+            return nullptr;
+
+        char* aligned = (char*)(((size_t)block + HugePageSize - 1) / HugePageSize * HugePageSize);
+        if (aligned != block)
+            ::munmap(block, aligned - block);
+        ::munmap(aligned + bytes, block + mapped - (aligned + bytes));
+        return aligned;
+    }
+
+    static void UnmapBlock(void* block, size_t bytes)
+    {
+        ::munmap(block, bytes);
+    }
+#endif
+
+    static void AdviseHugePages(void* block, size_t bytes)
+    {
+#if defined(MADV_HUGEPAGE)
+        // it is only advice, so failure is ignored(e.g. transparent huge pages are disabled).
+        ::madvise(block, bytes, MADV_HUGEPAGE);
+#endif
+    }
+};
+
+template<typename T, typename U, bool ExplicitHugePages>
+bool operator==(const HugePageAllocator<T, ExplicitHugePages>&, const HugePageAllocator<U, ExplicitHugePages>&)
+{
+    return true;
+}
+
+template<typename T, typename U, bool ExplicitHugePages>
+bool operator!=(const HugePageAllocator<T, ExplicitHugePages>&, const HugePageAllocator<U, ExplicitHugePages>&)
+{
+    return false;
+}
+
+void TestHugePageAllocator()
+{
+    HugePageAllocator<int> alloc;
+    // small block from operator new, large blocks are mapped.
+    int* small = alloc.allocate(16);
+    small[15] = 15;
+    alloc.deallocate(small, 16);
+
+    size_t count = 1024 * 1024;
+    int* ptr = alloc.allocate(count);
+    for (size_t i = 0; i < count; ++i)
+        ptr[i] = int(i);
+    cout << "huge page aligned: " << ((size_t)ptr % HugePageAllocator<int>::HugePageSize == 0) << endl;
+
+    // grow by remapping, old values are kept.
+    ptr = alloc.reallocate(ptr, count, count * 3);
+    bool kept = true;
+    for (size_t i = 0; i < count; ++i)
+        kept = kept && ptr[i] == int(i);
+    ptr[count * 3 - 1] = 1;
+    cout << "values kept after reallocate: " << kept << endl;
+
+    // a block mapped right behind it makes growing in place fail, pages move to an aligned range.
+    int* blocker = alloc.allocate(count);
+    ptr = alloc.reallocate(ptr, count * 3, count * 8);
+    cout << "huge page aligned after move: " << ((size_t)ptr % HugePageAllocator<int>::HugePageSize == 0)
+        << ", values kept: " << (ptr[count - 1] == int(count - 1) && ptr[count * 3 - 1] == 1) << endl;
+    alloc.deallocate(blocker, count);
+    alloc.deallocate(ptr, count * 8);
+}
+
+#endif
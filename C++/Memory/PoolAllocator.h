@@ -0,0 +1,235 @@
+//**************************************************************
+//         allocator serving single objects from a node pool
+//**************************************************************
+#ifndef POOL_ALLOCATOR_H
+#define POOL_ALLOCATOR_H
+
+#include <new>
+#include <type_traits>
+#include <utility>
+#include "Allocator.h"
+
+using namespace std;
+
+// node based containers(List) allocate one object per element, a heap call for every insert
+// and erase is the main cost of a list that churns, e.g. orders of a price level.
+// PoolAllocator serves single objects from chunks it owns:
+// 1. chunks are allocated from operator new, the first one holds FirstChunkCount objects and
+//    every next one doubles up to ChunkBytes, so small lists stay small and large ones take
+//    a few big allocations.
+// 2. deallocated objects are kept in a free list and handed out again last in first out,
+//    the most recently freed slot is most likely still in cache.
+// 3. release_all() frees every chunk at once, container calls it when it holds no elements
+//    anymore(Clear), instead of deallocating nodes one by one.
+// allocate(count) for count other than 1 goes to operator new as Allocator<T>.
+//
+// each allocator owns its pool: a copy starts with an empty pool and compares unequal,
+// moving transfers the chunks. objects can only be deallocated through the allocator that
+// allocated them, so nodes cannot be relinked between containers using different pools,
+// List::Splice and List::Merge move the elements into new nodes instead.
+template<typename T, size_t ChunkBytes = 64 * 1024>
+class PoolAllocator : public Allocator<T>
+{
+    // free slot keeps link to next free slot in its own storage.
+    union Slot
+    {
+        Slot* next;
+        typename std::aligned_storage<sizeof(T), std::alignment_of<T>::value>::type storage;
+    };
+
+public:
+    typedef T value_type;
+    typedef value_type* pointer;
+    typedef size_t size_type;
+
+    static const size_t FirstChunkCount = 16;
+
+    template<typename U>
+    struct rebind
+    {
+        typedef PoolAllocator<U, ChunkBytes> other;
+    };
+
+    PoolAllocator()
+        :_chunks(nullptr), _free(nullptr), _bump(nullptr), _bumpEnd(nullptr), _nextChunkCount(FirstChunkCount), _chunkCount(0)
+    {
+    }
+
+    PoolAllocator(const PoolAllocator&)
+        :Allocator<T>(), _chunks(nullptr), _free(nullptr), _bump(nullptr), _bumpEnd(nullptr), _nextChunkCount(FirstChunkCount), _chunkCount(0)
+    {
+    }
+
+    template<typename U>
+    PoolAllocator(const PoolAllocator<U, ChunkBytes>&)
+        :Allocator<T>(), _chunks(nullptr), _free(nullptr), _bump(nullptr), _bumpEnd(nullptr), _nextChunkCount(FirstChunkCount), _chunkCount(0)
+    {
+    }
+
+    PoolAllocator(PoolAllocator&& other)
+        :Allocator<T>(), _chunks(nullptr), _free(nullptr), _bump(nullptr), _bumpEnd(nullptr), _nextChunkCount(FirstChunkCount), _chunkCount(0)
+    {
+        Swap(other);
+    }
+
+    ~PoolAllocator()
+    {
+        release_all();
+    }
+
+    // pool is not copied, allocator keeps its own chunks.
+    PoolAllocator& operator=(const PoolAllocator&)
+    {
+        return *this;
+    }
+
+    PoolAllocator& operator=(PoolAllocator&& other)
+    {
+        if (this != &other)
+        {
+            release_all();
+            Swap(other);
+        }
+        return *this;
+    }
+
+    void Swap(PoolAllocator& other)
+    {
+        std::swap(_chunks, other._chunks);
+        std::swap(_free, other._free);
+        std::swap(_bump, other._bump);
+        std::swap(_bumpEnd, other._bumpEnd);
+        std::swap(_nextChunkCount, other._nextChunkCount);
+        std::swap(_chunkCount, other._chunkCount);
+    }
+
+    pointer allocate(size_type count)
+    {
+        if (count != 1)
+            return Allocator<T>::allocate(count);
+
+        Slot* slot = _free;
+        if (slot != nullptr)
+        {
+            _free = slot->next;
+        }
+        else
+        {
+            if (_bump == _bumpEnd)
+            {
+                NewChunk();
+            }
+            slot = _bump++;
+        }
+        return (T*)slot;
+    }
+
+    void deallocate(pointer ptr, size_type count)
+    {
+        if (count != 1)
+        {
+            Allocator<T>::deallocate(ptr, count);
+            return;
+        }
+
+        Slot* slot = (Slot*)ptr;
+        slot->next = _free;
+        _free = slot;
+    }
+
+    // single objects are slots of a chunk, malloc can not be asked about them.
+    size_type usable_size(const T* ptr, size_type count) const
+    {
+        return count != 1 ? Allocator<T>::usable_size(ptr, count) : 1;
+    }
+
+    // frees all chunks, every object allocated from the pool must have been destroyed.
+    void release_all()
+    {
+        Slot* chunk = _chunks;
+        while (chunk != nullptr)
+        {
+            Slot* next = chunk->next;
+            ::operator delete(chunk);
+            chunk = next;
+        }
+        _chunks = nullptr;
+        _free = nullptr;
+        _bump = nullptr;
+        _bumpEnd = nullptr;
+        _nextChunkCount = FirstChunkCount;
+        _chunkCount = 0;
+    }
+
+    // number of chunks held by the pool.
+    size_type chunk_count() const
+    {
+        return _chunkCount;
+    }
+
+private:
+    // first slot of a chunk links the chunks, objects are carved from the rest.
+    void NewChunk()
+    {
+        size_t count = _nextChunkCount;
+        Slot* chunk = (Slot*)::operator new((count + 1) * sizeof(Slot));
+        chunk->next = _chunks;
+        _chunks = chunk;
+        _bump = chunk + 1;
+        _bumpEnd = chunk + 1 + count;
+        ++_chunkCount;
+
+        size_t maxCount = ChunkBytes / sizeof(Slot);
+        if (_nextChunkCount * 2 <= maxCount)
+        {
+            _nextChunkCount *= 2;
+        }
+    }
+
+private:
+    Slot* _chunks;          // chunks, linked through their first slot
+    Slot* _free;            // freed slots, last freed first
+    Slot* _bump;            // next never used slot of the newest chunk
+    Slot* _bumpEnd;
+    size_t _nextChunkCount; // objects in next chunk
+    size_t _chunkCount;
+};
+
+// pools of different allocators are never shared, only an allocator can free its objects.
+template<typename T, typename U, size_t ChunkBytes>
+bool operator==(const PoolAllocator<T, ChunkBytes>& left, const PoolAllocator<U, ChunkBytes>& right)
+{
+    return (const void*)&left == (const void*)&right;
+}
+
+template<typename T, typename U, size_t ChunkBytes>
+bool operator!=(const PoolAllocator<T, ChunkBytes>& left, const PoolAllocator<U, ChunkBytes>& right)
+{
+    return !(left == right);
+}
+
+void TestPoolAllocator()
+{
+    PoolAllocator<double> alloc;
+    double* first = alloc.allocate(1);
+    double* second = alloc.allocate(1);
+    *first = 1.0;
+    *second = 2.0;
+
+    // freed slots are reused last in first out.
+    alloc.deallocate(first, 1);
+    alloc.deallocate(second, 1);
+    cout << "last freed reused first: " << (alloc.allocate(1) == second) << endl;
+    cout << "then the one before: " << (alloc.allocate(1) == first) << endl;
+
+    // chunks double from 16 objects, 1000 objects need 6 chunks(16+32+...+512).
+    for (int i = 0; i < 998; ++i)
+    {
+        alloc.allocate(1);
+    }
+    cout << "chunks for 1000 objects: " << alloc.chunk_count() << endl;
+    alloc.release_all();
+    cout << "chunks after release: " << alloc.chunk_count() << endl;
+}
+
+#endif
@@ -3,11 +3,15 @@
 //**************************************************************
 
 #include "Allocator.h"
+#include "HugePageAllocator.h"
+#include "PoolAllocator.h"
 #include "TestAlignment.h"
 
 int main()
 {
     TestAlignment();
     TestAllocator();
+    TestHugePageAllocator();
+    TestPoolAllocator();
 }
 
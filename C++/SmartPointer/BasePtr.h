@@ -5,70 +5,65 @@
 #ifndef BASEPTR_H
 #define BASEPTR_H
 
+#include <atomic>
+#include <utility>
+
+// SharedPtr and WeakPtr copies can live in different threads, so reference counts are atomic:
+// two threads dropping their copies at the same time must not both see count 1(double delete)
+// or lose an update(leak). the managed object itself is not protected, only its ownership.
+//
+// counting as std::shared_ptr:
+// strongRefCount: number of SharedPtr owning the object, object is deleted when it drops to 0.
+// weakRefCount: number of WeakPtr + 1 while any SharedPtr exists, the reference block is
+// deleted when it drops to 0, so a WeakPtr can still check Expired() after the object is gone.
+//
+// memory order: increments are relaxed since a new copy can only be made from an existing one,
+// which already keeps the count above 0. decrements are acq_rel so all writes of other owners
+// to the object happen before it is deleted by the last owner.
 template<typename T>
 class BasePtr
 {
 public:
-    BasePtr(T* p = nullptr)
+    BasePtr(T* p = nullptr) :pRef(p == nullptr ? nullptr : new Reference(p))
     {
-        pRef = new Reference(p);
     }
 
+    // ownership is released by SharedPtr/WeakPtr dtor, BasePtr does not know which kind it is.
     ~BasePtr()
     {
-        if (pRef != nullptr)
-        {
-            if (--pRef->strongRefCount == 0)
-            {
-                delete pRef;
-                pRef = nullptr;
-            }
-        }
     }
 
-    // make copying another BasePtr point to same resource.
-    BasePtr(BasePtr& sp) :pRef(sp.pRef)
-    {
-        pRef->strongRefCount++;
-    }
-
-    BasePtr<T>& operator=(BasePtr<T>& sp)
-    {
-        // check for self-assignment.
-        if (this == &sp)
-        {
-            return *this;
-        }
-
-        pRef = sp.pRef;
-        pRef->strongRefCount++;
-        return *this;
-    }
+    // copying must go through _Reset/_ResetW of SharedPtr/WeakPtr, which count the right reference.
+    BasePtr(const BasePtr&) = delete;
+    BasePtr& operator=(const BasePtr&) = delete;
 
     // return raw pointer.
     T* GetRaw() const
     {
-        return pRef->rawPointer;
+        return pRef == nullptr ? nullptr : pRef->rawPointer;
     }
 
-    int UseCount()
+    int UseCount() const
     {
-        return pRef->strongRefCount;
+        return pRef == nullptr ? 0 : pRef->strongRefCount.load(std::memory_order_acquire);
     }
 
     void IncreaseRef()
     {
-        pRef->strongRefCount++;
+        pRef->strongRefCount.fetch_add(1, std::memory_order_relaxed);
     }
 
     void IncreaseWeakRef()
     {
-        pRef->weakRefCount++;
+        pRef->weakRefCount.fetch_add(1, std::memory_order_relaxed);
     }
 
     void DecreaseWeakRef()
     {
-        pRef->weakRefCount--;
+        if (pRef->weakRefCount.fetch_sub(1, std::memory_order_acq_rel) == 1)
+        {
+            delete pRef;
+        }
     }
 
     void _Swap(BasePtr& other)
@@ -76,49 +71,85 @@ public:
         std::swap(pRef, other.pRef);
     }
 
-    // releases the ownership of the managed object, if any. 
+    // releases the ownership of the managed object, if any.
     void _Reset()
     {
-        pRef->strongRefCount--;
+        if (pRef != nullptr)
+        {
+            // the last SharedPtr deletes the object, then gives up the weak reference held for all SharedPtr.
+            if (pRef->strongRefCount.fetch_sub(1, std::memory_order_acq_rel) == 1)
+            {
+                delete pRef->rawPointer;
+                pRef->rawPointer = nullptr;
+                DecreaseWeakRef();
+            }
+        }
         // make this shared ptr own nothing.
         pRef = nullptr;
-        // should we handle raw pointer here? No. raw pointer's destruction relies on whether any managing shared ptr own it.
-        // one shared ptr reset does not mean there is no more other shared ptr own it.
     }
 
     void _ResetW()
     {
-        pRef->weakRefCount--;
+        if (pRef != nullptr)
+        {
+            DecreaseWeakRef();
+        }
         pRef = nullptr;
     }
 
-    void _Reset(BasePtr& other)
+    // share ownership with other. count of other is increased before the old one is released,
+    // so assigning a pointer to itself does not delete the object.
+    void _Reset(const BasePtr& other)
     {
-        pRef = other.pRef;
-        IncreaseRef();
+        Reference* ref = other.pRef;
+        if (ref != nullptr)
+        {
+            ref->strongRefCount.fetch_add(1, std::memory_order_relaxed);
+        }
+        _Reset();
+        pRef = ref;
     }
 
-    void _ResetW(BasePtr& other)
+    void _ResetW(const BasePtr& other)
     {
-        pRef = other.pRef;
-        IncreaseWeakRef();
+        Reference* ref = other.pRef;
+        if (ref != nullptr)
+        {
+            ref->weakRefCount.fetch_add(1, std::memory_order_relaxed);
+        }
+        _ResetW();
+        pRef = ref;
+    }
+
+    // share ownership with a WeakPtr if the object is still alive, otherwise own nothing.
+    // count is increased only if it is not 0, another thread could be deleting the object.
+    void _Lock(const BasePtr& weak)
+    {
+        _Reset();
+        Reference* ref = weak.pRef;
+        if (ref == nullptr)
+            return;
+
+        int count = ref->strongRefCount.load(std::memory_order_relaxed);
+        while (count != 0)
+        {
+            if (ref->strongRefCount.compare_exchange_weak(count, count + 1, std::memory_order_acq_rel, std::memory_order_relaxed))
+            {
+                pRef = ref;
+                return;
+            }
+        }
     }
 
 private:
     struct Reference
     {
         T* rawPointer;
-        int strongRefCount;
-        int weakRefCount;
-
-        Reference(T* p) :rawPointer(p), strongRefCount(1), weakRefCount(0)
-        {
-        };
+        std::atomic<int> strongRefCount;
+        std::atomic<int> weakRefCount;
 
-        ~Reference()
+        Reference(T* p) :rawPointer(p), strongRefCount(1), weakRefCount(1)
         {
-            delete rawPointer;
-            rawPointer = nullptr;
         };
     };
 
@@ -5,6 +5,7 @@
 #ifndef SHAREDPTR_H
 #define SHAREDPTR_H
 
+#include <utility>
 #include "BasePtr.h"
 #include "WeakPtr.h"
 
@@ -370,27 +371,35 @@ template<typename T>
 class SharedPtr: public BasePtr<T>
 {
 public:
-    SharedPtr(T* p = nullptr) :BasePtr(p)
+    SharedPtr(T* p = nullptr) :BasePtr<T>(p)
     {
     }
 
     ~SharedPtr()
     {
+        this->_Reset();
     }
 
     // make copying SharedPtr point to same resource.
-    SharedPtr(SharedPtr& sp)
+    SharedPtr(const SharedPtr& sp) :BasePtr<T>()
     {
         this->_Reset(sp);
     }
 
+    // take over resource of sp, no reference count is changed.
+    SharedPtr(SharedPtr&& sp)
+    {
+        this->_Swap(sp);
+    }
+
     // SharedPtr should be able to contruct from WeakPtr.
-    SharedPtr(WeakPtr<T>& wp)
+    // it is empty if the resource was already deleted.
+    SharedPtr(const WeakPtr<T>& wp)
     {
-        this->_Reset(wp);
+        this->_Lock(wp);
     }
 
-    SharedPtr<T>& operator=(SharedPtr<T>& sp)
+    SharedPtr<T>& operator=(const SharedPtr<T>& sp)
     {
         // check for self-assignment.
         if (this == &sp)
@@ -398,7 +407,13 @@ public:
             return *this;
         }
 
-        _Reset(sp);
+        this->_Reset(sp);
+        return *this;
+    }
+
+    SharedPtr<T>& operator=(SharedPtr<T>&& sp)
+    {
+        SharedPtr(std::move(sp)).Swap(*this);
         return *this;
     }
 
@@ -426,6 +441,13 @@ public:
         return this->GetRaw();
     }
 
+    // whether this is the only SharedPtr owning the resource, e.g. to decide if it can be modified
+    // without copying(copy-on-write). it is only reliable if no other thread copies this SharedPtr concurrently.
+    bool Unique() const
+    {
+        return this->UseCount() == 1;
+    }
+
     void Swap(SharedPtr& other)
     {
         this->_Swap(other);
@@ -6,8 +6,12 @@
 #include "SharedPtr.h"
 #include "WeakPtr.h"
 #include "UniquePtr.h"
+#include <atomic>
+#include <cassert>
 #include <memory>
 #include <iostream>
+#include <thread>
+#include <vector>
 
 using namespace std;
 // test object
@@ -150,6 +154,50 @@ void CyclicReference_Test()
     p2->ptr = p1;// ref count=2
 }
 
+// object counting its destruction.
+struct Counted
+{
+    static std::atomic<int> destroyed;
+    ~Counted()
+    {
+        destroyed++;
+    }
+};
+
+std::atomic<int> Counted::destroyed(0);
+
+void SharedPtr_ThreadSafe_Test()
+{
+    SharedPtr<Counted> sp(new Counted);
+    WeakPtr<Counted> wp(sp);
+
+    // copies are made and dropped in several threads at the same time.
+    std::vector<std::thread> threads;
+    for (int t = 0; t < 4; t++)
+    {
+        threads.push_back(std::thread([&sp, &wp]()
+        {
+            for (int i = 0; i < 100000; i++)
+            {
+                SharedPtr<Counted> copy(sp);
+                SharedPtr<Counted> locked = wp.Lock();
+                assert(locked.Get() != nullptr);
+            }
+        }));
+    }
+    for (auto& thread : threads)
+    {
+        thread.join();
+    }
+
+    cout << "use count after threads: " << sp.UseCount() << endl;
+    assert(sp.UseCount() == 1 && Counted::destroyed == 0);
+
+    sp.Reset();
+    assert(Counted::destroyed == 1 && wp.Expired() && wp.Lock().Get() == nullptr);
+    cout << "object destroyed once, weak ptr expired: " << wp.Expired() << endl;
+}
+
 void UniquePtr_Test()
 {
     int* p = new int(5);
@@ -170,5 +218,6 @@ int main()
     //CyclicReference_Test();
     //WeakPtr_Test();
     UniquePtr_Test();
+    SharedPtr_ThreadSafe_Test();
 }
 
@@ -115,21 +115,21 @@ public:
 
     ~WeakPtr()
     {
+        this->_ResetW();
     }
 
-    WeakPtr(SharedPtr<T>& sp)
+    WeakPtr(const SharedPtr<T>& sp)
     {
         this->_ResetW(sp);
     }
 
-    // copy ctor from another WeakPtr. weak ptr can only contruct from shared ptr,
-    // here copied weak ptr will be promoted to shared ptr then call copy ctor.
-    WeakPtr(WeakPtr& sp)
+    // copy ctor from another WeakPtr, both observe the same resource.
+    WeakPtr(const WeakPtr& sp)
     {
         this->_ResetW(sp);
     }
 
-    WeakPtr<T>& operator=(WeakPtr<T>& sp)
+    WeakPtr<T>& operator=(const WeakPtr<T>& sp)
     {
         // check for self-assignment.
         if (this == &sp)
@@ -141,7 +141,7 @@ public:
         return *this;
     }
 
-    WeakPtr<T>& operator=(SharedPtr<T>& sp)
+    WeakPtr<T>& operator=(const SharedPtr<T>& sp)
     {
         this->_ResetW(sp);
         return *this;
@@ -150,7 +150,7 @@ public:
     // checks whether the referenced object was already deleted.
     bool Expired()
     {
-        return UseCount() == 0;
+        return this->UseCount() == 0;
     }
 
     // creates a SharedPtr that manages the referenced object.